@@ -17,6 +17,7 @@
 #include <esp_partition.h>
 #include <AutoConnectCredential.h>
 #include <string.h>
+#include <vector>
 
 /**
  * Retrieve saved credentials from eeprom partition.
@@ -55,6 +56,7 @@ void convert(const uint8_t* eeprom, const size_t size) {
     Serial.println("AC_CREDT identifier not found in the partition.");
   else {
     AutoConnectCredential credential;
+    std::vector<station_config_t> configs;
     uint8_t*  bp = ac_credt + sizeof("AC_CREDT") - sizeof('\0');
     uint8_t*  dp = bp;
     uint8_t   entries = *dp++;
@@ -63,6 +65,8 @@ void convert(const uint8_t* eeprom, const size_t size) {
     Serial.printf("%d stored credential(s),size:%d\n", (int)entries, dpSize);
 
     // Start EEPROM to Preferences migration
+    // All entries are collected first and then transferred with one
+    // commit to Preferences.
     uint8_t*  ep = dp + dpSize - 1;
     for (int ec = 1; dp <= ep; ec++) {
 
@@ -102,8 +106,12 @@ void convert(const uint8_t* eeprom, const size_t size) {
           }
         }
       }
-      bool rc = credential.save(&config);
-      Serial.println(rc ? " transferred" : " failed to save Preferences");
+      configs.push_back(config);
+      Serial.println();
+    }
+    if (configs.size()) {
+      bool rc = credential.save(configs.data(), configs.size());
+      Serial.printf("%d credential(s) %s\n", (int)configs.size(), rc ? "transferred" : "failed to save Preferences");
     }
   }
 }
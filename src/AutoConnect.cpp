@@ -8,6 +8,18 @@
  */
 
 #include "AutoConnect.h"
+#if defined(ARDUINO_ARCH_ESP8266)
+#include <core_version.h>
+#if defined(ARDUINO_ESP8266_MAJOR) && ARDUINO_ESP8266_MAJOR >= 3
+// esp_delay of core 3.x ends the sleep only when the blocked condition
+// is released, esp_schedule alone does not end it.
+#include <coredecls.h>
+#define AC_ESP_DELAY
+#endif
+#elif defined(ARDUINO_ARCH_ESP32)
+// The bit of the wait event group to wake the waiter of _waitForEvent
+#define AC_WAITEVENT_WAKE   0x01
+#endif
 #ifdef ARDUINO_ARCH_ESP32
 #include <esp_wifi.h>
 #endif
@@ -22,6 +34,43 @@
 #define	SET_HOSTNAME(x)	do { WiFi.setHostname(x); } while(0)
 #endif
 
+/**
+ *  Scan on the specified channel, 0 means all channels. arduino-esp32
+ *  prior to 2.0 cannot specify the channel to be scanned, in which case
+ *  the scan plan always sweeps all channels.
+ */
+#if defined(ARDUINO_ARCH_ESP8266)
+#define SCAN_CHANNEL(a, c)  WiFi.scanNetworks(a, true, c)
+#elif defined(ARDUINO_ARCH_ESP32)
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 2
+#define SCAN_CHANNEL(a, c)  WiFi.scanNetworks(a, true, false, 300, c)
+#else
+#define SCAN_CHANNEL(a, c)  WiFi.scanNetworks(a, true)
+#define AC_NOSCAN_CHANNEL
+#endif
+#endif
+
+/**
+ *  Scan for the specified SSID only, without the hidden networks.
+ *  The ssid argument of the scan is available from arduino-esp32 2.0.5,
+ *  the prior releases sweep all channels instead and the caller filters
+ *  the result by the SSID.
+ */
+#if defined(ARDUINO_ARCH_ESP8266)
+#define SCAN_SSID(a, s)     WiFi.scanNetworks(a, false, 0, reinterpret_cast<uint8_t*>(const_cast<char*>(s)))
+#elif defined(ARDUINO_ARCH_ESP32)
+#if defined(ESP_ARDUINO_VERSION_VAL)
+#if ESP_ARDUINO_VERSION >= ESP_ARDUINO_VERSION_VAL(2, 0, 5)
+#define AC_SCAN_SSID
+#endif
+#endif
+#ifdef AC_SCAN_SSID
+#define SCAN_SSID(a, s)     WiFi.scanNetworks(a, false, false, 300, 0, s)
+#else
+#define SCAN_SSID(a, s)     ((void)(s), SCAN_CHANNEL(a, 0))
+#endif
+#endif
+
 
 /**
  *  AutoConnect default constructor. This entry activates WebServer
@@ -51,6 +100,12 @@ AutoConnect::AutoConnect(WebServerClass& webServer)
  */
 AutoConnect::~AutoConnect() {
   end();
+#ifdef ARDUINO_ARCH_ESP32
+  if (_taskLock)
+    vSemaphoreDelete(_taskLock);
+  if (_waitEvents)
+    vEventGroupDelete(_waitEvents);
+#endif
 }
 
 /**
@@ -75,34 +130,24 @@ bool AutoConnect::begin(void) {
 bool AutoConnect::begin(const char* ssid, const char* passphrase, unsigned long timeout) {
   bool  cs;
 
+  // The blocking begin runs the portal by itself.
+  _stopTask();
+  _beginProfile(false);
+
   // Overwrite for the current timeout value.
   if (timeout == 0)
     timeout = _apConfig.beginTimeout;
 
-  if (_apConfig.preserveAPMode && !_apConfig.autoRise) {
-    // Captive portal will not be started on connection failure. Enable Station mode
-    // without disabling any current soft AP.
-    cs = WiFi.enableSTA(true);
-    AC_DBG("WiFi mode %d maintained, STA %s\n", WiFi.getMode(), cs ? "enabled" : "unavailable");
-  }
-  else {
-    // Start WiFi connection with station mode.
-    WiFi.softAPdisconnect(true);
-    if (!WiFi.mode(WIFI_STA))
-      AC_DBG("Unable start WIFI_STA\n");
-    delay(100);
-  }
-
-  // Set host name
-  if (_apConfig.hostName.length())
-    SET_HOSTNAME(_apConfig.hostName.c_str());
+  // The blocking begin does not use the state machine of beginAsync.
+  _beginState = AC_BEGINSTATE_IDLE;
+  _roamPhase = AC_ROAMPHASE_IDLE;
+  _pending |= AC_PENDING_BUSY;
+  _attachWaitEvents();
 
-  // Start Ticker according to the WiFi condition with Ticker is available.
-  if (_apConfig.ticker) {
-    _ticker.reset(new AutoConnectTicker(_apConfig.tickerPort, _apConfig.tickerOn));
-    if (WiFi.status() != WL_CONNECTED)
-      _ticker->start(AUTOCONNECT_FLICKER_PERIODDC, (uint8_t)AUTOCONNECT_FLICKER_WIDTHDC);
-  }
+  // Start WiFi connection with station mode.
+  if (_prepareSTA())
+    delay(100);
+  _enterPhase(AC_BOOTPHASE_CREDENTIAL);
 
   // If the portal is requested promptly skip the first WiFi.begin and
   // immediately start the portal.
@@ -116,46 +161,61 @@ bool AutoConnect::begin(const char* ssid, const char* passphrase, unsigned long
     if (_getConfigSTA(&current))
       AC_DBG("Current:%.32s\n", current.ssid);
 
-    // Prepare valid configuration according to the WiFi connection right order.
-    cs = true;
+    // Attempt the fast reconnect with the lease cached in the RTC memory.
+    cs = false;
+    _candidateCount = _candidateNext = 0;
     _rfAdHocBegin = ssid == nullptr ? false : (strlen(ssid) > 0);
-    if (_rfAdHocBegin) {
-      // Save for autoReconnect
-      strcpy(reinterpret_cast<char*>(_credential.ssid), ssid);
-      if (passphrase)
-        strcpy(reinterpret_cast<char*>(_credential.password), passphrase);
+    if (_apConfig.fastReconnect && !_rfAdHocBegin) {
+      if (_beginFastReconnect())
+        cs = _waitForConnect(AUTOCONNECT_FASTRECONNECT_TIMEOUT) == WL_CONNECTED;
     }
-    else {
-      // AC_PRINCIPLE_RSSI is available when SSID and password are not provided.
-      if (_apConfig.principle == AC_PRINCIPLE_RSSI) {
-        // Find the strongest signal from the broadcast among the saved credentials.
-        if ((cs = _loadCurrentCredential(reinterpret_cast<char*>(current.ssid), reinterpret_cast<char*>(current.password), AC_PRINCIPLE_RSSI, false))) {
-          ssid = reinterpret_cast<const char*>(current.ssid);
-          passphrase = reinterpret_cast<const char*>(current.password);
-          AC_DBG("Adopted:%.32s\n", ssid);
+
+    if (!cs) {
+      // Prepare valid configuration according to the WiFi connection right order.
+      cs = true;
+      if (_rfAdHocBegin) {
+        // Save for autoReconnect
+        strcpy(reinterpret_cast<char*>(_credential.ssid), ssid);
+        if (passphrase)
+          strcpy(reinterpret_cast<char*>(_credential.password), passphrase);
+      }
+      else {
+        // AC_PRINCIPLE_RSSI and AC_PRINCIPLE_LATENCY are available when
+        // SSID and password are not provided.
+        if (_apConfig.principle != AC_PRINCIPLE_RECENT) {
+          // Find the strongest signal or the fastest one to connect from the
+          // broadcast among the saved credentials.
+          if ((cs = _loadCurrentCredential(reinterpret_cast<char*>(current.ssid), reinterpret_cast<char*>(current.password), _apConfig.principle, false))) {
+            ssid = reinterpret_cast<const char*>(current.ssid);
+            passphrase = reinterpret_cast<const char*>(current.password);
+            AC_DBG("Adopted:%.32s\n", ssid);
+          }
         }
+        _loadAvailCredential(reinterpret_cast<const char*>(current.ssid));
       }
-      _loadAvailCredential(reinterpret_cast<const char*>(current.ssid));
-    }
 
-    if (cs) {
-      // Advance configuration for STA mode. Restore previous configuration of STA.
-      // _loadAvailCredential(reinterpret_cast<const char*>(current.ssid));
-      if (!_configSTA(_apConfig.staip, _apConfig.staGateway, _apConfig.staNetmask, _apConfig.dns1, _apConfig.dns2))
-        return false;
+      if (cs) {
+        // Advance configuration for STA mode. Restore previous configuration of STA.
+        // _loadAvailCredential(reinterpret_cast<const char*>(current.ssid));
+        _enterPhase(AC_BOOTPHASE_CONNECT);
+        if (!_configSTA(_apConfig.staip, _apConfig.staGateway, _apConfig.staNetmask, _apConfig.dns1, _apConfig.dns2)) {
+          _endProfile(false);
+          return false;
+        }
 
-      // Try to connect by STA immediately.
-      if (!_rfAdHocBegin)
-        cs = WiFi.begin() != WL_CONNECT_FAILED;
-      else {
-        _disconnectWiFi(false);
-        cs = WiFi.begin(ssid, passphrase) != WL_CONNECT_FAILED;
-      }
-      AC_DBG("WiFi.begin(%s%s%s)", ssid == nullptr ? "" : ssid, passphrase == nullptr ? "" : ",", passphrase == nullptr ? "" : passphrase);
-      if (cs)
-        cs = _waitForConnect(timeout) == WL_CONNECTED;
-      else {
-        AC_DBG_DUMB(" failed\n");
+        // Try to connect by STA immediately.
+        if (!_rfAdHocBegin)
+          cs = WiFi.begin() != WL_CONNECT_FAILED;
+        else {
+          _disconnectWiFi(false);
+          cs = WiFi.begin(ssid, passphrase) != WL_CONNECT_FAILED;
+        }
+        AC_DBG("WiFi.begin(%s%s%s)", ssid == nullptr ? "" : ssid, passphrase == nullptr ? "" : ",", passphrase == nullptr ? "" : passphrase);
+        if (cs)
+          cs = _waitForConnect(timeout) == WL_CONNECTED;
+        else {
+          AC_DBG_DUMB(" failed\n");
+        }
       }
     }
 
@@ -165,15 +225,28 @@ bool AutoConnect::begin(const char* ssid, const char* passphrase, unsigned long
       char  ssid_c[sizeof(station_config_t::ssid) + sizeof('\0')];
       char  password_c[sizeof(station_config_t::password) + sizeof('\0')];
       AC_DBG("autoReconnect");
-      if ((cs = _loadCurrentCredential(ssid_c, password_c, _apConfig.principle, strlen(reinterpret_cast<const char*>(current.ssid)) > 0))) {
+      // With the failover, the candidates that remain from the scan at
+      // the first attempt are walked without rescanning.
+      bool  loaded;
+      if (_candidateNext < _candidateCount)
+        loaded = _loadNextCredential(ssid_c, password_c);
+      else
+        loaded = _loadCurrentCredential(ssid_c, password_c, _apConfig.principle, strlen(reinterpret_cast<const char*>(current.ssid)) > 0);
+      while (loaded) {
         // Try to reconnect with a stored credential.
-        AC_DBG_DUMB(", %s(%s) loaded\n", ssid_c, _apConfig.principle == AC_PRINCIPLE_RECENT ? "RECENT" : "RSSI");
+        AC_DBG_DUMB(", %s(%s) loaded\n", ssid_c, _apConfig.principle == AC_PRINCIPLE_RECENT ? "RECENT" : (_apConfig.principle == AC_PRINCIPLE_RSSI ? "RSSI" : "LATENCY"));
         const char* psk = strlen(password_c) ? password_c : nullptr;
+        _enterPhase(AC_BOOTPHASE_CONNECT);
         _configSTA(IPAddress(_credential.config.sta.ip), IPAddress(_credential.config.sta.gateway), IPAddress(_credential.config.sta.netmask), IPAddress(_credential.config.sta.dns1), IPAddress(_credential.config.sta.dns2));
         cs = WiFi.begin(ssid_c, psk) != WL_CONNECT_FAILED;
         AC_DBG("WiFi.begin(%s%s%s)", ssid_c, psk == nullptr ? "" : ",", psk == nullptr ? "" : psk);
         if (cs)
           cs = _waitForConnect(timeout) == WL_CONNECTED;
+        if (cs)
+          break;
+        // Each candidate is attempted with its own timeout.
+        if ((loaded = _loadNextCredential(ssid_c, password_c)))
+          AC_DBG("failover");
       }
       if (!cs) {
         AC_DBG_DUMB(" failed\n");
@@ -213,6 +286,7 @@ bool AutoConnect::begin(const char* ssid, const char* passphrase, unsigned long
         // Prepare for redirecting captive portal detection.
         // Pass all URL requests to _captivePortal to disguise the captive portal.
         _startDNSServer();
+        _endProfile(true);
 
         // The following two lines are the trick statements.
         // They have the effect of avoiding unintended automatic
@@ -268,9 +342,57 @@ bool AutoConnect::begin(const char* ssid, const char* passphrase, unsigned long
   if (!_responsePage)
     _startWebServer();
 
+  _endProfile(false);
+
+  // Hand over the portal to the dedicated task if it is configured.
+  _startTask();
   return cs;
 }
 
+/**
+ *  Starts establishing WiFi connection without blocking.
+ *  The same sequence as AutoConnect::begin, which consists of the
+ *  connection attempt, the autoReconnect, SoftAP activation and the
+ *  captive portal, proceeds as a state machine that AutoConnect::handleClient
+ *  advances. One handleClient stops advancing the state when
+ *  AutoConnectConfig::asyncBudget has been spent, as best-effort. The progress can
+ *  be known by beginState and the exit routine registered with onBeginState.
+ *  @param  ssid        SSID to be connected.
+ *  @param  passphrase  Password for connection.
+ *  @param  timeout     A time out value in milliseconds for waiting connection.
+ *  @return true        The connection sequence has started.
+ *  @return false       beginAsync is already in progress.
+ */
+bool AutoConnect::beginAsync(const char* ssid, const char* passphrase, unsigned long timeout) {
+  if (_isBeginInProgress()) {
+    AC_DBG("beginAsync already in progress\n");
+    return false;
+  }
+  _stopTask();
+  _beginProfile(true);
+  _beginTimeout = timeout ? timeout : _apConfig.beginTimeout;
+  _candidateCount = _candidateNext = 0;
+
+  // Start WiFi connection with station mode. The settling of the WiFi
+  // mode will be waited for in AC_BEGINSTATE_SETUP.
+  _prepareSTA();
+
+  // Save the credential specified with beginAsync for the connection
+  // attempt in AC_BEGINSTATE_SETUP and autoReconnect.
+  _rfAdHocBegin = ssid == nullptr ? false : (strlen(ssid) > 0);
+  if (_rfAdHocBegin) {
+    strncpy(reinterpret_cast<char*>(_credential.ssid), ssid, sizeof(station_config_t::ssid));
+    memset(_credential.password, 0x00, sizeof(station_config_t::password));
+    if (passphrase)
+      strncpy(reinterpret_cast<char*>(_credential.password), passphrase, sizeof(station_config_t::password));
+  }
+  _setBeginState(AC_BEGINSTATE_SETUP);
+  _pending |= AC_PENDING_BUSY;
+  _attachWaitEvents();
+  _startTask();
+  return true;
+}
+
 /**
  *  Configure AutoConnect portal access point.
  *  @param  ap      SSID for access point.
@@ -328,6 +450,99 @@ bool AutoConnect::_configSTA(const IPAddress& ip, const IPAddress& gateway, cons
   return rc;
 }
 
+/**
+ *  Prepare the station mode prior to the connection attempt, also the
+ *  host name and the ticker are set up.
+ *  @return true    WiFi mode has been switched and needs to settle.
+ *  @return false   WiFi mode is maintained.
+ */
+bool AutoConnect::_prepareSTA(void) {
+  bool  settle = false;
+
+  if (_apConfig.preserveAPMode && !_apConfig.autoRise) {
+    // Captive portal will not be started on connection failure. Enable Station mode
+    // without disabling any current soft AP.
+    bool  cs = WiFi.enableSTA(true);
+    AC_DBG("WiFi mode %d maintained, STA %s\n", WiFi.getMode(), cs ? "enabled" : "unavailable");
+    (void)(cs);
+  }
+  else {
+    // Start WiFi connection with station mode.
+    WiFi.softAPdisconnect(true);
+    if (!WiFi.mode(WIFI_STA))
+      AC_DBG("Unable start WIFI_STA\n");
+    settle = true;
+  }
+
+  // Set host name
+  if (_apConfig.hostName.length())
+    SET_HOSTNAME(_apConfig.hostName.c_str());
+
+  // Start Ticker according to the WiFi condition with Ticker is available.
+  if (_apConfig.ticker) {
+    _ticker.reset(new AutoConnectTicker(_apConfig.tickerPort, _apConfig.tickerOn));
+    if (WiFi.status() != WL_CONNECTED)
+      _ticker->start(AUTOCONNECT_FLICKER_PERIODDC, (uint8_t)AUTOCONNECT_FLICKER_WIDTHDC);
+  }
+  return settle;
+}
+
+/**
+ *  Start the fast reconnect with the lease cached in the RTC memory.
+ *  The lease holds the channel, BSSID and IP addresses of the last
+ *  established connection, it allows skipping the scan and the DHCP
+ *  negotiation. The lease is renewed by the normal connection with the
+ *  DHCP each AUTOCONNECT_FASTRECONNECT_RENEW times.
+ *  @return true    WiFi.begin with the lease has started.
+ *  @return false   No valid lease, or it should be renewed.
+ */
+bool AutoConnect::_beginFastReconnect(void) {
+  AutoConnectLease  rtc;
+  AutoConnectLease_t  lease;
+
+  _rfFastReconnect = false;
+  if (!rtc.load(&lease)) {
+    AC_DBG("No lease cached\n");
+    return false;
+  }
+  if (lease.uses >= AUTOCONNECT_FASTRECONNECT_RENEW) {
+    AC_DBG("Lease to be renewed\n");
+    return false;
+  }
+
+  // The passphrase is reloaded from the saved credential which the lease
+  // refers to. The lease is void if the credential has been changed.
+  // The credential being attempted, it is evaluated by the connection
+  // statistics when the attempt fails.
+  AutoConnectCredential credential(_apConfig.boundaryOffset);
+  memset(&_credential, 0x00, sizeof(station_config_t));
+  if (!credential.load(static_cast<int8_t>(lease.entry), &_credential) || AutoConnectLease::hash(_credential.ssid) != lease.ssidHash) {
+    AC_DBG("Lease credential changed\n");
+    memset(&_credential, 0x00, sizeof(station_config_t));
+    rtc.clear();
+    return false;
+  }
+  memcpy(_credential.bssid, lease.bssid, sizeof(station_config_t::bssid));
+  _leaseUses = lease.uses;
+
+  char  ssid_c[sizeof(station_config_t::ssid) + sizeof('\0')];
+  char  password_c[sizeof(station_config_t::password) + sizeof('\0')];
+  *ssid_c = '\0';
+  strncat(ssid_c, reinterpret_cast<const char*>(_credential.ssid), sizeof(ssid_c) - 1);
+  *password_c = '\0';
+  strncat(password_c, reinterpret_cast<const char*>(_credential.password), sizeof(password_c) - 1);
+  _enterPhase(AC_BOOTPHASE_CONNECT);
+  if (!_configSTA(IPAddress(lease.ip), IPAddress(lease.gateway), IPAddress(lease.netmask), IPAddress(lease.dns1), IPAddress(lease.dns2)))
+    return false;
+  AC_DBG("WiFi.begin(%s,ch%d,%02x:%02x:%02x:%02x:%02x:%02x) fast", ssid_c, (int)lease.channel, lease.bssid[0], lease.bssid[1], lease.bssid[2], lease.bssid[3], lease.bssid[4], lease.bssid[5]);
+  _rfFastReconnect = WiFi.begin(ssid_c, strlen(password_c) ? password_c : nullptr, lease.channel, lease.bssid) != WL_CONNECT_FAILED;
+  if (!_rfFastReconnect) {
+    AC_DBG_DUMB(" failed\n");
+    rtc.clear();
+  }
+  return _rfFastReconnect;
+}
+
 /**
  *  Get URI to redirect at boot. It uses the URI according to the
  *  AutoConnectConfig::bootUti setting with the AutoConnectConfig::homeUri
@@ -382,12 +597,16 @@ bool AutoConnect::_getConfigSTA(station_config_t* config) {
  *  Stops AutoConnect captive portal service.
  */
 void AutoConnect::end(void) {
+  _stopTask();
+  _beginState = AC_BEGINSTATE_IDLE;
+  _roamPhase = AC_ROAMPHASE_IDLE;
   _currentPageElement.reset();
   _ticker.reset();
   _update.reset();
   _ota.reset();
 
   _stopPortal();
+  _detachWaitEvents();
   _dnsServer.reset();
   _webServer.reset();
 }
@@ -412,26 +631,90 @@ uint16_t AutoConnect::getEEPROMUsedSize(void) {
  *  Invoke the handleClient of parent web server to process client request of
  *  AutoConnect WEB interface.
  *  No effects when the web server is not available.
+ *  While the dedicated portal task is running, the call from the other
+ *  tasks has no effect.
  */
 void AutoConnect::handleClient(void) {
+  if (_isForeignTask())
+    return;
+
   // Is there DNS Server process next request?
-  if (_dnsServer)
-    _dnsServer->processNextRequest();
+  if (_dnsServer) {
+    uint16_t  queries = _dnsServer->processNextRequest();
+    AC_METRICS(_metrics.dns(queries));
+    if (queries)
+      AC_TRACE(AC_TRACEID_DNS, queries, 0);
+  }
   // handleClient valid only at _webServer activated.
-  if (_webServer)
-    _webServer->handleClient();
+  if (_webServer) {
+    _serveClient();
+    AC_EVENTS(_handleEvents());
+  }
 
   handleRequest();
 }
 
+/**
+ *  Let the web server handle a request with the bookkeeping of the heap
+ *  trace, the metrics and the scratch arena. handleClient and the
+ *  serving wait of _waitForEvent share it. It is not re-entered from a
+ *  page handler.
+ */
+void AutoConnect::_serveClient(void) {
+  if (_rfServing)
+    return;
+  _rfServing = true;
+  AC_HEAPTRACE_BEGIN();
+  AC_ARENA(AutoConnectArena::open());
+  _webServer->handleClient();
+  AC_HEAPTRACE_END();
+  AC_METRICS(_recordRequest());
+  AC_ARENA(_releaseArena());
+  _rfServing = false;
+}
+
 /**
  *  Handling for the AutoConnect menu request.
  */
 void AutoConnect::handleRequest(void) {
   bool  skipPostTicker;
 
+  // The dedicated portal task owns the processing.
+  if (_isForeignTask())
+    return;
+
+  // Fast path for the idle state. Nothing needs to be processed unless
+  // a WiFi event or a portal request has occurred, or a process is in
+  // progress. The full pass still runs every AUTOCONNECT_IDLE_REFRESH
+  // for the timers and the changes made outside AutoConnect.
+  if (!_pending && !_rfConnect && !_rfDisconnect && !_rfReset) {
+    if (millis() - _idleChecked < AUTOCONNECT_IDLE_REFRESH) {
+#if defined(AUTOCONNECT_USE_TRACE) && AUTOCONNECT_TRACE_DRAIN > 0
+      // The trace records are formatted while nothing is in progress.
+      AutoConnectTrace::drain(AC_DEBUG_PORT, AUTOCONNECT_TRACE_DRAIN);
+#endif
+      return;
+    }
+  }
+  _pending = 0;
+  _idleChecked = millis();
+  AC_METRICS(_metrics.sampleHeap());
+
+  // Process the WiFi events that occurred since the previous pass.
+  _handleWiFiEvents();
+
+  // Advance the connection sequence started by beginAsync. It owns the
+  // reconnection and the portal startup until it has finished.
+  if (_isBeginInProgress())
+    _handleBeginAsync();
+
+  // The directed connection for roaming owns the reconnection until it
+  // has concluded.
+  else if (_roamPhase == AC_ROAMPHASE_CONNECT)
+    _handleRoaming();
+
   // Controls reconnection and portal startup when WiFi is disconnected.
-  if (WiFi.status() != WL_CONNECTED) {
+  else if (WiFi.status() != WL_CONNECTED) {
 
     // Launch the captive portal when SoftAP is active and autoRise is
     // specified to be maintained.
@@ -458,11 +741,19 @@ void AutoConnect::handleRequest(void) {
       // intervals of time with AutoConnectConfig::reconnectInterval value
       // multiplied by AUTOCONNECT_UNITTIME.
       if (sc == WIFI_SCAN_FAILED) {
-        if (millis() - _attemptPeriod > ((unsigned long)_apConfig.reconnectInterval * AUTOCONNECT_UNITTIME * 1000)) {
-          int8_t  sn = WiFi.scanNetworks(true, true);
-          AC_DBG("autoReconnect %s\n", sn == WIFI_SCAN_RUNNING ? "running" : "failed");
+        if (!_reconnectWait)
+          _reconnectWait = _reconnectDelay();
+        if (millis() - _attemptPeriod > _reconnectWait) {
+          _planScan();
+          int8_t  sn = _scanNext(true);
+          AC_TDBG("autoReconnect %s\n", sn == WIFI_SCAN_RUNNING ? "running" : "failed");
           _attemptPeriod = millis();
           (void)(sn);
+          // Schedule the next attempt, it will be taken over by the
+          // connection attempt if a known access point is found.
+          if (_reconnectAttempts < UINT8_MAX)
+            _reconnectAttempts++;
+          _reconnectWait = _reconnectDelay();
         }
       }
 
@@ -470,20 +761,37 @@ void AutoConnect::handleRequest(void) {
       // access point. If it is found, it will generate a connection
       // request inside.
       else if (sc != WIFI_SCAN_RUNNING) {
-        AC_DBG("%d network(s) found\n", (int)sc);
+        AC_METRICS(_metrics.endScan());
+        AC_TRACE(AC_TRACEID_SCANEND, sc, 0);
+        AC_EVENTS(AutoConnectEvents::push(PSTR("scan"), sc));
+        AC_TDBG("%d network(s) found\n", (int)sc);
         if (sc > 0) {
           if (_seekCredential(_apConfig.principle, _rfAdHocBegin ? AC_SEEKMODE_CURRENT : AC_SEEKMODE_ANY))
             _rfConnect = true;
         }
         WiFi.scanDelete();
+        // Continue the scan plan on the next channel when missed.
+        if (!_rfConnect && _scanPlanNext < _scanPlanCount)
+          _scanNext(true);
       }
     }
   }
-  else
+  else {
+    // The backoff restarts with the next disconnection.
     _attemptPeriod = millis();
+    _reconnectAttempts = 0;
+    _reconnectWait = 0;
+    // Watch the link quality for roaming.
+    _handleRoaming();
+  }
 
   // Handling processing requests to AutoConnect.
   if (_rfConnect) {
+    // The station is driven by the portal from here, the reconnection
+    // to the current AP must not interfere. It is set again when the
+    // new connection is established.
+    _setReconnect(AC_RECONNECT_RESET);
+
     // Leave from the AP currently.
     if (WiFi.status() == WL_CONNECTED)
       _disconnectWiFi(true);
@@ -503,84 +811,41 @@ void AutoConnect::handleRequest(void) {
     strncat(ssid_c, reinterpret_cast<const char*>(_credential.ssid), sizeof(ssid_c) - 1);
     *password_c = '\0';
     strncat(password_c, reinterpret_cast<const char*>(_credential.password), sizeof(password_c) - 1);
-    AC_DBG("WiFi.begin(%s%s%s) ch(%d)", ssid_c, strlen(password_c) ? "," : "", strlen(password_c) ? password_c : "", (int)ch);
+    AC_TRACE(AC_TRACEID_CONNECT, ch, AutoConnectTrace::hash(ssid_c));
+    AC_TDBG("WiFi.begin(%s%s%s) ch(%d)", ssid_c, strlen(password_c) ? "," : "", strlen(password_c) ? password_c : "", (int)ch);
 
     if (WiFi.begin(ssid_c, password_c, ch) != WL_CONNECT_FAILED) {
-      // Wait for the connection attempt to complete and send a response
-      // page to notify the connection result.
-      // End the current session to complete a response page transmission.
-      _rsConnect = _waitForConnect(_apConfig.beginTimeout);
-      do {
-        _webServer->handleClient();
-      } while (_webServer->client());
-
-      if (_rsConnect == WL_CONNECTED) {
-        // WLAN successfully connected then release the DNS server.
-        // Also, stop WIFI_AP if retainPortal not specified.
-        _stopDNSServer();
-        if (!_apConfig.retainPortal) {
-          WiFi.softAPdisconnect(true);
-          WiFi.enableAP(false);
-        }
-        else {
-          AC_DBG("Maintain SoftAP\n");
-        }
-
-        // It will automatically save the credential which was able to
-        // establish current connection.
-        if (WiFi.BSSID() != NULL) {
-          memcpy(_credential.bssid, WiFi.BSSID(), sizeof(station_config_t::bssid));
-          _currentHostIP = WiFi.localIP();
-          _redirectURI = String(F(AUTOCONNECT_URI_SUCCESS));
-
-          // Save current credential
-          if (_apConfig.autoSave == AC_SAVECREDENTIAL_AUTO) {
-            AutoConnectCredential credit(_apConfig.boundaryOffset);
-            if (credit.save(&_credential)) {
-              AC_DBG("%.*s credential saved\n", sizeof(_credential.ssid), reinterpret_cast<const char*>(_credential.ssid));
-            }
-            else {
-              AC_DBG("credential %.*s save failed\n", sizeof(_credential.ssid), reinterpret_cast<const char*>(_credential.ssid));
-            }
-          }
-
-          // Ensures that keeps a connection with the current AP
-          // while the portal behaves.
-          _setReconnect(AC_RECONNECT_SET);
-        }
-        else {
-          AC_DBG("%.*s has no BSSID, saving is unavailable\n", sizeof(_credential.ssid), reinterpret_cast<const char*>(_credential.ssid));
-        }
-
-        // Activate AutoConnectUpdate if it is attached and incorporate
-        // it into the AutoConnect menu.
-        if (_update)
-          _update->enable();
-      }
+      // With beginAsync, the state machine polls the connection result
+      // without blocking and the response page will be sent by the
+      // subsequent handleClient.
+      if (_beginState == AC_BEGINSTATE_PORTAL)
+        _setBeginState(AC_BEGINSTATE_PORTALCONNECT);
       else {
-        _currentHostIP = WiFi.softAPIP();
-        _redirectURI = String(F(AUTOCONNECT_URI_FAIL));
-        _disconnectWiFi(false);
-        wl_status_t wl = WiFi.status();
-        unsigned long tm = millis();
-        while (wl != WL_IDLE_STATUS && wl != WL_DISCONNECTED && wl != WL_NO_SSID_AVAIL) {
-          if (millis() - tm > 3000)
-            break;
-          delay(1);
-          yield();
-          wl = WiFi.status();
-        }
-        AC_DBG("Quit connecting, status(%d)\n", wl);
+        // Wait for the connection attempt to complete and send a response
+        // page to notify the connection result.
+        // End the current session to complete a response page transmission.
+        _rsConnect = _waitForConnect(_apConfig.beginTimeout);
+        do {
+          _webServer->handleClient();
+        } while (_webServer->client());
+        _handleConnectResult();
       }
     }
     _rfConnect = false;
+    // With the failover, the next candidate found by the autoReconnect
+    // will be attempted at the next turn.
+    if (WiFi.status() != WL_CONNECTED && _beginState != AC_BEGINSTATE_PORTALCONNECT)
+      _rfConnect = _loadNextCredential(ssid_c, password_c);
   }
 
   if (_rfReset) {
     // Reset or disconnect by portal operation result
     _stopPortal();
     AC_DBG("Reset\n");
-    delay(1000);
+    // Reset as soon as the client leaves.
+    _waitForEvent([this]() {
+      return !_webServer->client().connected();
+    }, 1000, false);
     SOFT_RESET();
     delay(1000);
   }
@@ -589,26 +854,23 @@ void AutoConnect::handleRequest(void) {
     // Response for disconnection request is not completed while
     // the session exists.
     if (!_webServer->client()) {
-      // Disconnect from the current AP.
+      // Disconnect from the current AP, and do not come back to it.
+      _setReconnect(AC_RECONNECT_RESET);
       _disconnectWiFi(false);
-      while (WiFi.status() == WL_CONNECTED) {
-        delay(10);
-        yield();
-      }
-      AC_DBG("Disconnected ");
+      AC_TRACE(AC_TRACEID_DISCONNECT, _apConfig.retainPortal, 0);
+      AC_TDBG("Disconnected ");
       if ((WiFi.getMode() & WIFI_AP) && !_apConfig.retainPortal) {
         _stopPortal();
       }
       else {
         if (_dnsServer)
-          AC_DBG_DUMB("- Portal maintained");
-        AC_DBG_DUMB("\n");
+          AC_TDBG_DUMB("- Portal maintained");
+        AC_TDBG_DUMB("\n");
       }
       // Reset disconnection request
       _rfDisconnect = false;
 
       if (_apConfig.autoReset) {
-        delay(1000);
         SOFT_RESET();
         delay(1000);
       }
@@ -674,6 +936,10 @@ void AutoConnect::handleRequest(void) {
         _ticker->start(tCycle, tWidth);
     }    
   }
+
+  // The next turn can take the fast path only if nothing is in progress.
+  if (_isBeginInProgress() || _roamPhase != AC_ROAMPHASE_IDLE || WiFi.status() != WL_CONNECTED || (_ota && _ota->status() != AutoConnectOTA::OTA_IDLE))
+    _pending |= AC_PENDING_BUSY;
 }
 
 /**
@@ -820,6 +1086,15 @@ bool AutoConnect::on(const String& uri, const AuxHandlerFunctionT handler, AutoC
   return false;
 }
 
+/**
+ *  Register the exit routine that is being called when the state of
+ *  beginAsync changes.
+ *  @param  fn  A function of the exit routine.
+ */
+void AutoConnect::onBeginState(BeginStateExit_ft fn) {
+  _onBeginStateExit = fn;
+}
+
 /**
  *  Register the exit routine that is being called when WiFi connected.
  *  @param  fn  A function of the exit routine.
@@ -853,77 +1128,683 @@ void AutoConnect::whileCaptivePortal(WhileCaptivePortalExit_ft fn) {
 }
 
 /**
- *  Load current available credential
- *  @param  ssid      A pointer to the buffer that SSID should be stored.
- *  @param  password  A pointer to the buffer that password should be stored.
- *  @param  principle  WiFi connection principle.
- *  @param  excludeCurrent  Skip loading the current SSID.
- *  @return true  Current SSID and password returned.
- *  @return false There is no available SSID.
+ *  Advance the state machine of beginAsync by one step. Each step does
+ *  not block, it polls the WiFi status and the scan result instead of
+ *  waiting for them.
+ *  @return true  The state has transitioned.
+ *  @return false The state remains, waiting for the next turn.
  */
-bool AutoConnect::_loadCurrentCredential(char* ssid, char* password, const AC_PRINCIPLE_t principle, const bool excludeCurrent) {
-  bool  rc;
+bool AutoConnect::_advanceBegin(void) {
+  wl_status_t wifiStatus;
+  bool  fastReconnect;
+  int8_t  sc;
+  char  ssid_c[sizeof(station_config_t::ssid) + 1];
+  char  password_c[sizeof(station_config_t::password) + 1];
+
+  switch (_beginState) {
+  case AC_BEGINSTATE_SETUP:
+    // Wait for the STA mode to settle.
+    if (millis() - _stateEntry < 100)
+      break;
+    if (_apConfig.immediateStart) {
+      // If the portal is requested promptly skip the first WiFi.begin and
+      // immediately start the portal.
+      AC_DBG("Start the portal immediately\n");
+      _startPortal();
+    }
+    else if (_apConfig.fastReconnect && !_rfAdHocBegin && _beginFastReconnect())
+      _setBeginState(AC_BEGINSTATE_CONNECT);
+    else if (!_rfAdHocBegin && _apConfig.principle != AC_PRINCIPLE_RECENT) {
+      // AC_PRINCIPLE_RSSI and AC_PRINCIPLE_LATENCY choose the credential
+      // with the scan result.
+      station_config_t  current;
+      memset(&current, 0x00, sizeof(station_config_t));
+      _getConfigSTA(&current);
+      _beginExcludeCurrent = strlen(reinterpret_cast<const char*>(current.ssid)) > 0;
+      _planScan();
+      _scanNext(true);
+      _setBeginState(AC_BEGINSTATE_SCAN);
+    }
+    else
+      _beginStation();
+    return true;
 
-  if ((rc = _loadAvailCredential(nullptr, principle, excludeCurrent))) {
-    strcpy(ssid, reinterpret_cast<const char*>(_credential.ssid));
-    strcpy(password, reinterpret_cast<const char*>(_credential.password));
-  }
-  return rc;
-}
+  case AC_BEGINSTATE_SCAN:
+  case AC_BEGINSTATE_RESCAN:
+    // Seek a saved credential that matches the scan result according
+    // to the AutoConnectConfig::principle.
+    if ((sc = WiFi.scanComplete()) == WIFI_SCAN_RUNNING)
+      break;
+    AC_METRICS(_metrics.endScan());
+    AC_TRACE(AC_TRACEID_SCANEND, sc, 0);
+    AC_EVENTS(AutoConnectEvents::push(PSTR("scan"), sc));
+    AC_DBG("%d network(s) found\n", (int)sc);
+    if (sc > 0) {
+      AC_SEEKMODE_t mode = _beginState == AC_BEGINSTATE_RESCAN && _beginExcludeCurrent ? AC_SEEKMODE_NEWONE : AC_SEEKMODE_ANY;
+      if (_seekCredential(_apConfig.principle, mode)) {
+        WiFi.scanDelete();
+        *ssid_c = '\0';
+        strncat(ssid_c, reinterpret_cast<const char*>(_credential.ssid), sizeof(ssid_c) - 1);
+        *password_c = '\0';
+        strncat(password_c, reinterpret_cast<const char*>(_credential.password), sizeof(password_c) - 1);
+        AC_DBG("%s loaded\n", ssid_c);
+        if (_beginState == AC_BEGINSTATE_SCAN) {
+          // Restore the static IPs of the adopted credential.
+          _loadAvailCredential(ssid_c);
+          if (!_configSTA(_apConfig.staip, _apConfig.staGateway, _apConfig.staNetmask, _apConfig.dns1, _apConfig.dns2)) {
+            _setBeginState(AC_BEGINSTATE_FAILED);
+            return true;
+          }
+        }
+        else
+          _configSTA(IPAddress(_credential.config.sta.ip), IPAddress(_credential.config.sta.gateway), IPAddress(_credential.config.sta.netmask), IPAddress(_credential.config.sta.dns1), IPAddress(_credential.config.sta.dns2));
+        AC_DBG("WiFi.begin(%s%s%s)\n", ssid_c, strlen(password_c) ? "," : "", password_c);
+        if (WiFi.begin(ssid_c, strlen(password_c) ? password_c : nullptr) != WL_CONNECT_FAILED) {
+          _setBeginState(_beginState == AC_BEGINSTATE_SCAN ? AC_BEGINSTATE_CONNECT : AC_BEGINSTATE_RECONNECT);
+          return true;
+        }
+      }
+    }
+    WiFi.scanDelete();
+    // Continue the scan plan on the next channel when missed.
+    if (_scanPlanNext < _scanPlanCount) {
+      _scanNext(true);
+      break;
+    }
+    // No saved credential is in the vicinity. As begin does, the first
+    // attempt is made with the current STA configuration, and its failure
+    // leads to the autoReconnect. The miss of the autoReconnect rescan
+    // starts the portal.
+    if (_beginState == AC_BEGINSTATE_SCAN)
+      _beginStation();
+    else
+      _startPortal();
+    return true;
 
-/**
- *  Load stored credentials that match nearby WLANs.
- *  @param  ssid  SSID which should be loaded. If nullptr is assigned, search SSID with WiFi.scan.
- *  @param  principle  WiFi connection principle.
- *  @param  excludeCurrent  Skip loading the current SSID.
- *  @return true  A matched credential of BSSID was loaded.
- */
-bool AutoConnect::_loadAvailCredential(const char* ssid, const AC_PRINCIPLE_t principle, const bool excludeCurrent) {
-  AutoConnectCredential credential(_apConfig.boundaryOffset);
+  case AC_BEGINSTATE_CONNECT:
+  case AC_BEGINSTATE_RECONNECT:
+  case AC_BEGINSTATE_PORTALCONNECT:
+    // Wait for establishment of the connection until the timeout.
+    wifiStatus = WiFi.status();
+    if (wifiStatus != WL_CONNECTED) {
+      if (_rfFastReconnect) {
+        if (millis() - _stateEntry <= AUTOCONNECT_FASTRECONNECT_TIMEOUT)
+          break;
+      }
+      else if (!_beginTimeout || millis() - _stateEntry <= _beginTimeout)
+        break;
+    }
+    fastReconnect = _rfFastReconnect;
+    _settleConnect(wifiStatus, millis() - _stateEntry);
+    if (fastReconnect && wifiStatus != WL_CONNECTED)
+      // The cached lease has been discarded, retry with the normal
+      // connection sequence.
+      _setBeginState(AC_BEGINSTATE_SETUP);
+    else if (_beginState == AC_BEGINSTATE_PORTALCONNECT) {
+      // Respond to the connection request from the portal.
+      _rsConnect = wifiStatus;
+      _handleConnectResult();
+      if (wifiStatus == WL_CONNECTED)
+        _setBeginState(AC_BEGINSTATE_CONNECTED);
+      else {
+        _portalAccessPeriod = millis();
+        _setBeginState(AC_BEGINSTATE_PORTAL);
+      }
+    }
+    else if (wifiStatus == WL_CONNECTED) {
+      _currentHostIP = WiFi.localIP();
+      // Activate AutoConnectUpdate if it is attached and incorporate it into the AutoConnect menu.
+      if (_update)
+        _update->enable();
+      // It doesn't matter the connection status for launching the Web server.
+      if (!_responsePage)
+        _startWebServer();
+      _setBeginState(AC_BEGINSTATE_CONNECTED);
+    }
+    else if (_beginState == AC_BEGINSTATE_CONNECT)
+      _beginFallback();
+    else if (!_beginNextCandidate())
+      _startPortal();
+    return true;
 
-  if (credential.entries() > 0) {
-    // Scan the vicinity only when the saved credentials are existing.
-    if (!ssid) {
-      int8_t  nn = WiFi.scanNetworks(false, true);
-      AC_DBG_DUMB(", %d network(s) found", (int)nn);
-      if (nn > 0)
-        return _seekCredential(principle, excludeCurrent ? AC_SEEKMODE_NEWONE : AC_SEEKMODE_ANY);
+  case AC_BEGINSTATE_SOFTAP:
+    // Activate the AP mode with configured softAP step by step.
+    if (!_advanceSoftAP())
+      break;
+    _currentHostIP = WiFi.softAPIP();
+    // Start Web server when TCP connection is enabled.
+    _startWebServer();
+    // Fork to the exit routine that starts captive portal.
+    if (_onDetectExit ? _onDetectExit(_currentHostIP) : true) {
+      // Prepare for redirecting captive portal detection.
+      _startDNSServer();
+      _portalAccessPeriod = millis();
+      _setBeginState(AC_BEGINSTATE_PORTAL);
     }
+    else
+      _setBeginState(AC_BEGINSTATE_FAILED);
+    return true;
 
-    // The SSID to load was specified.
-    // Set the IP configuration globally from the saved credential.
-    else if (strlen(ssid))
-      if (credential.load(ssid, &_credential) >= 0) {
-        if (_credential.dhcp == STA_STATIC) {
-          _apConfig.staip = static_cast<IPAddress>(_credential.config.sta.ip);
-          _apConfig.staGateway = static_cast<IPAddress>(_credential.config.sta.gateway);
-          _apConfig.staNetmask = static_cast<IPAddress>(_credential.config.sta.netmask);
-          _apConfig.dns1 = static_cast<IPAddress>(_credential.config.sta.dns1);
-          _apConfig.dns2 = static_cast<IPAddress>(_credential.config.sta.dns2);
-        }
+  case AC_BEGINSTATE_PORTAL:
+    // The connection request from the portal is handled by handleRequest.
+    if (WiFi.status() == WL_CONNECTED) {
+      _setBeginState(AC_BEGINSTATE_CONNECTED);
+      return true;
+    }
+    // By an exit routine to escape from Captive portal
+    if (_whileCaptivePortal) {
+      if (!_whileCaptivePortal()) {
+        _setBeginState(AC_BEGINSTATE_FAILED);
         return true;
       }
+    }
+    // Captive portal staying time exceeds timeout,
+    // Close the portal if an option for keeping the portal is false.
+    if (_hasTimeout(_apConfig.portalTimeout)) {
+      AC_DBG("CP timeout exceeded:%ld\n", millis() - _portalAccessPeriod);
+      if (_apConfig.retainPortal) {
+        _purgePages();
+        AC_DBG("Maintain portal\n");
+      }
+      else
+        _stopPortal();
+      _setBeginState(AC_BEGINSTATE_FAILED);
+      return true;
+    }
+    break;
+
+  default:
+    break;
   }
   return false;
 }
 
 /**
- *  Aims a connectable access point by seeking with the WiFi scan results.
- *  The collation uses the saved credentials, and the connection priority
- *  follows AutoConnectConfig::principle.
- *  Either BSSID or SSID of the collation key is determined at compile
- *  time according to the AUTOCONNECT_APKEY_SSID definition.
- *  @param  principle  WiFi connection principle.
- *  @param  mode  Seek mode for whether to target a specific SSID.
- *  @return true  A matched credential of BSSID was loaded.
+ *  Starts the 1st-WiFi.begin of beginAsync with the current STA
+ *  configuration or the credential specified with beginAsync.
  */
-bool AutoConnect::_seekCredential(const AC_PRINCIPLE_t principle, const AC_SEEKMODE_t mode) {
-  AutoConnectCredential credential(_apConfig.boundaryOffset);
-  station_config_t  validConfig;  // Temporary to find the strongest RSSI.
-  int32_t minRSSI = -120;         // Min value to find the strongest RSSI.
+void AutoConnect::_beginStation(void) {
+  wl_status_t wifiStatus;
 
-  // Seek SSID
-  const char* currentSSID = WiFi.SSID().c_str();
+  if (!_rfAdHocBegin) {
+    // Restore current STA configuration
+    station_config_t  current;
+    memset(&current, 0x00, sizeof(station_config_t));
+    if (_getConfigSTA(&current))
+      AC_DBG("Current:%.32s\n", current.ssid);
+    _beginExcludeCurrent = strlen(reinterpret_cast<const char*>(current.ssid)) > 0;
+    _loadAvailCredential(reinterpret_cast<const char*>(current.ssid));
+  }
+  if (!_configSTA(_apConfig.staip, _apConfig.staGateway, _apConfig.staNetmask, _apConfig.dns1, _apConfig.dns2)) {
+    _setBeginState(AC_BEGINSTATE_FAILED);
+    return;
+  }
+  // Try to connect by STA immediately.
+  if (!_rfAdHocBegin) {
+    AC_DBG("WiFi.begin()\n");
+    wifiStatus = WiFi.begin();
+  }
+  else {
+    char  ssid_c[sizeof(station_config_t::ssid) + 1];
+    char  password_c[sizeof(station_config_t::password) + 1];
+    // The disconnection is waited for within the budget, WiFi.begin
+    // supersedes the association in progress anyway.
+    _disconnectWiFi(false, _apConfig.asyncBudget ? _apConfig.asyncBudget : 1);
+    *ssid_c = '\0';
+    strncat(ssid_c, reinterpret_cast<const char*>(_credential.ssid), sizeof(ssid_c) - 1);
+    *password_c = '\0';
+    strncat(password_c, reinterpret_cast<const char*>(_credential.password), sizeof(password_c) - 1);
+    AC_DBG("WiFi.begin(%s%s%s)\n", ssid_c, strlen(password_c) ? "," : "", password_c);
+    wifiStatus = WiFi.begin(ssid_c, strlen(password_c) ? password_c : nullptr);
+  }
+  if (wifiStatus != WL_CONNECT_FAILED)
+    _setBeginState(AC_BEGINSTATE_CONNECT);
+  else
+    _beginFallback();
+}
+
+/**
+ *  Determines the next step after the 1st-WiFi.begin of beginAsync failed.
+ *  If the autoReconnect is enabled, it scans to find another saved
+ *  credential, otherwise, the captive portal starts.
+ */
+void AutoConnect::_beginFallback(void) {
+  if (_apConfig.autoReconnect && !_rfAdHocBegin) {
+    AC_DBG("autoReconnect\n");
+    // With the failover, the candidates that remain from the scan at
+    // the first attempt are walked without rescanning.
+    if (_beginNextCandidate())
+      return;
+    _planScan();
+    _scanNext(true);
+    _setBeginState(AC_BEGINSTATE_RESCAN);
+  }
+  else
+    _startPortal();
+}
+
+/**
+ *  Starts the connection attempt of beginAsync with the next candidate
+ *  ranked by _seekCredential.
+ *  @return true  The attempt has started.
+ *  @return false No more candidates.
+ */
+bool AutoConnect::_beginNextCandidate(void) {
+  char  ssid_c[sizeof(station_config_t::ssid) + 1];
+  char  password_c[sizeof(station_config_t::password) + 1];
+
+  while (_loadNextCredential(ssid_c, password_c)) {
+    AC_DBG("failover %s\n", ssid_c);
+    _configSTA(IPAddress(_credential.config.sta.ip), IPAddress(_credential.config.sta.gateway), IPAddress(_credential.config.sta.netmask), IPAddress(_credential.config.sta.dns1), IPAddress(_credential.config.sta.dns2));
+    if (WiFi.begin(ssid_c, strlen(password_c) ? password_c : nullptr) != WL_CONNECT_FAILED) {
+      _setBeginState(AC_BEGINSTATE_RECONNECT);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ *  Advance beginAsync within the time limit of AutoConnectConfig::asyncBudget.
+ *  The steps are repeated as long as the state transitions and the
+ *  budget remains. The budget is checked between the steps, so it is
+ *  best-effort. The steps that access the flash or start the servers
+ *  can exceed it by themselves.
+ */
+void AutoConnect::_handleBeginAsync(void) {
+  unsigned long tm = millis();
+  while (_isBeginInProgress() && _advanceBegin()) {
+    if (millis() - tm >= _apConfig.asyncBudget)
+      break;
+  }
+}
+
+/**
+ *  Transit the state of beginAsync and notify the exit routine.
+ *  @param  state  A new state.
+ */
+void AutoConnect::_setBeginState(const AC_BEGINSTATE_t state) {
+  _beginState = state;
+  _stateEntry = millis();
+  AC_TRACE(AC_TRACEID_BEGINSTATE, state, 0);
+  AC_DBG("beginAsync state:%d\n", (int)state);
+  switch (state) {
+  case AC_BEGINSTATE_SETUP:
+    _enterPhase(AC_BOOTPHASE_PREPARE);
+    break;
+  case AC_BEGINSTATE_SCAN:
+  case AC_BEGINSTATE_RESCAN:
+    _enterPhase(AC_BOOTPHASE_SCAN);
+    break;
+  case AC_BEGINSTATE_CONNECT:
+  case AC_BEGINSTATE_RECONNECT:
+    _enterPhase(AC_BOOTPHASE_CONNECT);
+    break;
+  case AC_BEGINSTATE_SOFTAP:
+    _enterPhase(AC_BOOTPHASE_SOFTAP);
+    break;
+  case AC_BEGINSTATE_PORTAL:
+  case AC_BEGINSTATE_CONNECTED:
+  case AC_BEGINSTATE_FAILED:
+    _endProfile(state == AC_BEGINSTATE_PORTAL);
+    break;
+  default:
+    break;
+  }
+  if (_onBeginStateExit)
+    _onBeginStateExit(state);
+}
+
+/**
+ *  Start profiling the phases of begin or beginAsync. The profile is
+ *  available with bootProfile.
+ *  @param  async   Profiling beginAsync.
+ */
+void AutoConnect::_beginProfile(const bool async) {
+  memset(&_bootProfile, 0x00, sizeof(AC_BOOTPROFILE_t));
+  _bootProfile.async = async;
+  _bootPhase = AC_BOOTPHASE_PREPARE;
+  _profileStart = _phaseEntry = micros();
+  _rfProfiling = true;
+}
+
+/**
+ *  Attribute the time since the entry of the current phase to it, and
+ *  enter the next phase. It does nothing unless profiling.
+ *  @param  phase   The phase to enter.
+ */
+void AutoConnect::_enterPhase(const AC_BOOTPHASE_t phase) {
+  if (!_rfProfiling)
+    return;
+  unsigned long now = micros();
+  _bootProfile.phase[_bootPhase] += now - _phaseEntry;
+  _phaseEntry = now;
+  _bootPhase = phase;
+}
+
+/**
+ *  End profiling. The captive portal loop that follows the portal
+ *  bring-up is not profiled.
+ *  @param  portal  The captive portal has become available.
+ */
+void AutoConnect::_endProfile(const bool portal) {
+  if (!_rfProfiling)
+    return;
+  _enterPhase(_bootPhase);
+  _rfProfiling = false;
+  if (portal)
+    _bootProfile.toPortal = micros() - _profileStart;
+  AC_METRICS(_metrics.boot(_bootProfile));
+  AC_DBG("Boot profile[us] prep:%lu,cred:%lu,scan:%lu,conn:%lu,ap:%lu,web:%lu,dns:%lu,connected:%lu,portal:%lu\n",
+    (unsigned long)_bootProfile.phase[AC_BOOTPHASE_PREPARE], (unsigned long)_bootProfile.phase[AC_BOOTPHASE_CREDENTIAL],
+    (unsigned long)_bootProfile.phase[AC_BOOTPHASE_SCAN], (unsigned long)_bootProfile.phase[AC_BOOTPHASE_CONNECT],
+    (unsigned long)_bootProfile.phase[AC_BOOTPHASE_SOFTAP], (unsigned long)_bootProfile.phase[AC_BOOTPHASE_WEBSERVER],
+    (unsigned long)_bootProfile.phase[AC_BOOTPHASE_DNS], (unsigned long)_bootProfile.toConnected, (unsigned long)_bootProfile.toPortal);
+}
+
+/**
+ *  Starts the captive portal of beginAsync with activating SoftAP. The
+ *  captive portal is effective at the autoRise is valid only.
+ */
+void AutoConnect::_startPortal(void) {
+  if (_apConfig.autoRise) {
+    // Change WiFi working mode, Enable AP with STA
+    WiFi.setAutoConnect(false);
+    _disconnectWiFi(false);
+    _softAPPhase = 0;
+    _setBeginState(AC_BEGINSTATE_SOFTAP);
+  }
+  else {
+    AC_DBG("Suppress autoRise\n");
+    if (!_responsePage)
+      _startWebServer();
+    _setBeginState(AC_BEGINSTATE_FAILED);
+  }
+}
+
+/**
+ *  Load current available credential
+ *  @param  ssid      A pointer to the buffer that SSID should be stored.
+ *  @param  password  A pointer to the buffer that password should be stored.
+ *  @param  principle  WiFi connection principle.
+ *  @param  excludeCurrent  Skip loading the current SSID.
+ *  @return true  Current SSID and password returned.
+ *  @return false There is no available SSID.
+ */
+bool AutoConnect::_loadCurrentCredential(char* ssid, char* password, const AC_PRINCIPLE_t principle, const bool excludeCurrent) {
+  bool  rc;
+
+  if ((rc = _loadAvailCredential(nullptr, principle, excludeCurrent))) {
+    strcpy(ssid, reinterpret_cast<const char*>(_credential.ssid));
+    strcpy(password, reinterpret_cast<const char*>(_credential.password));
+  }
+  return rc;
+}
+
+/**
+ *  Load stored credentials that match nearby WLANs.
+ *  @param  ssid  SSID which should be loaded. If nullptr is assigned, search SSID with WiFi.scan.
+ *  @param  principle  WiFi connection principle.
+ *  @param  excludeCurrent  Skip loading the current SSID.
+ *  @return true  A matched credential of BSSID was loaded.
+ */
+bool AutoConnect::_loadAvailCredential(const char* ssid, const AC_PRINCIPLE_t principle, const bool excludeCurrent) {
+  AutoConnectCredential credential(_apConfig.boundaryOffset);
+
+  if (credential.entries() > 0) {
+    // Scan the vicinity only when the saved credentials are existing.
+    if (!ssid) {
+      _planScan();
+      while (_scanPlanNext < _scanPlanCount) {
+        int8_t  nn = _scanNext(false);
+        AC_DBG_DUMB(", %d network(s) found", (int)nn);
+        if (nn > 0)
+          if (_seekCredential(principle, excludeCurrent ? AC_SEEKMODE_NEWONE : AC_SEEKMODE_ANY))
+            return true;
+      }
+      return false;
+    }
+
+    // The SSID to load was specified.
+    // Set the IP configuration globally from the saved credential.
+    else if (strlen(ssid))
+      if (credential.load(ssid, &_credential) >= 0) {
+        if (_credential.dhcp == STA_STATIC) {
+          _apConfig.staip = static_cast<IPAddress>(_credential.config.sta.ip);
+          _apConfig.staGateway = static_cast<IPAddress>(_credential.config.sta.gateway);
+          _apConfig.staNetmask = static_cast<IPAddress>(_credential.config.sta.netmask);
+          _apConfig.dns1 = static_cast<IPAddress>(_credential.config.sta.dns1);
+          _apConfig.dns2 = static_cast<IPAddress>(_credential.config.sta.dns2);
+        }
+        return true;
+      }
+  }
+  return false;
+}
+
+/**
+ *  Determine the delay until the next background reconnection. With
+ *  AutoConnectConfig::reconnectBackoff, the interval grows by the factor
+ *  each attempt up to AutoConnectConfig::reconnectCeiling, and the delay
+ *  is chosen at random within it (full jitter) so that the devices lost
+ *  the same access point do not reconnect in lockstep.
+ *  @return Delay from the previous attempt [ms].
+ */
+unsigned long AutoConnect::_reconnectDelay(void) {
+  unsigned long interval = (unsigned long)_apConfig.reconnectInterval * AUTOCONNECT_UNITTIME * 1000;
+  if (_apConfig.reconnectBackoff < 2)
+    return interval;
+
+  unsigned long ceiling = (unsigned long)_apConfig.reconnectCeiling * AUTOCONNECT_UNITTIME * 1000;
+  if (ceiling < interval)
+    ceiling = interval;
+  unsigned long window = interval;
+  for (uint8_t n = 0; n < _reconnectAttempts && window < ceiling; n++)
+    window = window > ceiling / _apConfig.reconnectBackoff ? ceiling : window * _apConfig.reconnectBackoff;
+  unsigned long delayTime = random(window) + 1;
+  AC_DBG("Reconnect backoff %lu/%lums\n", delayTime, window);
+  return delayTime;
+}
+
+/**
+ *  Roaming monitor that moves to a stronger BSSID of the same SSID.
+ *  It advances one step per call within handleClient. The RSSI of the
+ *  current link is smoothed, and when it falls below
+ *  AutoConnectConfig::roamThreshold, the scan for the current SSID runs
+ *  no more often than AutoConnectConfig::roamInterval. If another BSSID
+ *  exceeds the current link by AutoConnectConfig::roamHysteresis, it
+ *  makes the directed connection to that BSSID with the saved credential.
+ */
+void AutoConnect::_handleRoaming(void) {
+  wl_status_t wifiStatus;
+  int8_t  sc;
+  int32_t rssi;
+
+  switch (_roamPhase) {
+  case AC_ROAMPHASE_IDLE:
+    if (!_apConfig.roamThreshold || WiFi.scanComplete() == WIFI_SCAN_RUNNING)
+      break;
+    if (millis() - _roamSampled < AUTOCONNECT_ROAM_SAMPLING)
+      break;
+    _roamSampled = millis();
+    // Smooth the RSSI with exponentially weighted moving average of
+    // alpha = 1/4.
+    rssi = WiFi.RSSI();
+    _roamRSSI = _roamRSSI ? (_roamRSSI * 3 + rssi) / 4 : rssi;
+    if (_roamRSSI >= _apConfig.roamThreshold)
+      break;
+    if (_roamScanned && millis() - _roamScanned < (unsigned long)_apConfig.roamInterval * 1000)
+      break;
+    _roamScanned = millis();
+    AC_METRICS(_metrics.beginScan());
+    AC_TRACE(AC_TRACEID_SCANSTART, 0, true);
+    if (SCAN_SSID(true, WiFi.SSID().c_str()) == WIFI_SCAN_RUNNING) {
+      AC_DBG("Roaming scan, %d dBm\n", (int)_roamRSSI);
+      _roamPhase = AC_ROAMPHASE_SCAN;
+    }
+    break;
+
+  case AC_ROAMPHASE_SCAN:
+    if ((sc = WiFi.scanComplete()) == WIFI_SCAN_RUNNING)
+      break;
+    AC_METRICS(_metrics.endScan());
+    AC_TRACE(AC_TRACEID_SCANEND, sc, 0);
+    AC_EVENTS(AutoConnectEvents::push(PSTR("scan"), sc));
+    _roamPhase = AC_ROAMPHASE_IDLE;
+    if (sc > 0) {
+      // Find the strongest BSSID of the current SSID other than the
+      // associated one.
+      String  ssid = WiFi.SSID();
+      uint8_t*  current = WiFi.BSSID();
+      int8_t  nn = -1;
+      for (uint8_t n = 0; n < sc; n++) {
+        if (WiFi.SSID(n) != ssid || (current && !memcmp(WiFi.BSSID(n), current, sizeof(station_config_t::bssid))))
+          continue;
+        if (nn < 0 || WiFi.RSSI(n) > WiFi.RSSI(nn))
+          nn = n;
+      }
+      AutoConnectCredential credential(_apConfig.boundaryOffset);
+      if (nn >= 0 && WiFi.RSSI(nn) >= _roamRSSI + _apConfig.roamHysteresis && credential.load(ssid.c_str(), &_credential) >= 0) {
+        char  ssid_c[sizeof(station_config_t::ssid) + 1];
+        char  password_c[sizeof(station_config_t::password) + 1];
+        uint8_t bssid[sizeof(station_config_t::bssid)];
+        int32_t ch = WiFi.channel(nn);
+        memcpy(bssid, WiFi.BSSID(nn), sizeof(bssid));
+        memcpy(_credential.bssid, bssid, sizeof(station_config_t::bssid));
+        *ssid_c = '\0';
+        strncat(ssid_c, reinterpret_cast<const char*>(_credential.ssid), sizeof(ssid_c) - 1);
+        *password_c = '\0';
+        strncat(password_c, reinterpret_cast<const char*>(_credential.password), sizeof(password_c) - 1);
+        AC_DBG("Roaming %d dBm to %02x:%02x:%02x:%02x:%02x:%02x %d dBm\n", (int)_roamRSSI, bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5], (int)WiFi.RSSI(nn));
+        WiFi.scanDelete();
+        if (WiFi.begin(ssid_c, strlen(password_c) ? password_c : nullptr, ch, bssid) != WL_CONNECT_FAILED) {
+          _roamStarted = millis();
+          _roamPhase = AC_ROAMPHASE_CONNECT;
+        }
+        break;
+      }
+    }
+    WiFi.scanDelete();
+    break;
+
+  case AC_ROAMPHASE_CONNECT:
+    // Wait for the directed connection without blocking.
+    wifiStatus = WiFi.status();
+    if (wifiStatus != WL_CONNECTED && millis() - _roamStarted <= _apConfig.beginTimeout)
+      break;
+    _roamPhase = AC_ROAMPHASE_IDLE;
+    _roamRSSI = 0;
+    _settleConnect(wifiStatus, millis() - _roamStarted);
+    if (wifiStatus == WL_CONNECTED)
+      _roamCount++;
+    else {
+      // Release the BSSID restriction and leave the reconnection to the
+      // SDK or the autoReconnect.
+      char  ssid_c[sizeof(station_config_t::ssid) + 1];
+      char  password_c[sizeof(station_config_t::password) + 1];
+      *ssid_c = '\0';
+      strncat(ssid_c, reinterpret_cast<const char*>(_credential.ssid), sizeof(ssid_c) - 1);
+      *password_c = '\0';
+      strncat(password_c, reinterpret_cast<const char*>(_credential.password), sizeof(password_c) - 1);
+      WiFi.begin(ssid_c, strlen(password_c) ? password_c : nullptr);
+    }
+    AC_DBG("Roaming %s, %d time(s)\n", wifiStatus == WL_CONNECTED ? "completed" : "failed", (int)_roamCount);
+    break;
+  }
+}
+
+/**
+ *  Make a scan plan for seeking the saved credentials. With the
+ *  AutoConnectConfig::partialScan, the plan scans the channels on which
+ *  the connections have been established in order of the most recent
+ *  success, and the full sweep concludes the plan for a miss. The full
+ *  sweep is also planned every AUTOCONNECT_FULLSCAN_INTERVAL plans to
+ *  discover the access points that have moved to another channel.
+ */
+void AutoConnect::_planScan(void) {
+  _scanPlanCount = _scanPlanNext = 0;
+#ifndef AC_NOSCAN_CHANNEL
+  if (_apConfig.partialScan && _partialScans < AUTOCONNECT_FULLSCAN_INTERVAL) {
+    AutoConnectStats  stats;
+    _scanPlanCount = stats.channels(_scanPlan, sizeof(_scanPlan) - 1);
+    if (_scanPlanCount)
+      _partialScans++;
+  }
+#endif
+  _scanPlan[_scanPlanCount++] = 0;
+  AC_DBG("Scan plan:%d channel(s) and all\n", (int)_scanPlanCount - 1);
+}
+
+/**
+ *  Start the next scan of the plan.
+ *  @param  async   Scan asynchronously.
+ *  @return The result of WiFi.scanNetworks, WIFI_SCAN_FAILED if the
+ *  plan has been completed.
+ */
+int8_t AutoConnect::_scanNext(const bool async) {
+  if (_scanPlanNext >= _scanPlanCount)
+    return WIFI_SCAN_FAILED;
+  uint8_t ch = _scanPlan[_scanPlanNext++];
+  // A miss on the partial scan also falls into the full sweep, it
+  // restarts counting the interval.
+  if (!ch)
+    _partialScans = 0;
+  AC_METRICS(_metrics.beginScan());
+  AC_TRACE(AC_TRACEID_SCANSTART, ch, async);
+  AC_BOOTPHASE_t  phase = _bootPhase;
+  _enterPhase(AC_BOOTPHASE_SCAN);
+#ifdef AC_DEBUG
+  unsigned long tm = millis();
+#endif
+  int8_t  sc = SCAN_CHANNEL(async, ch);
+  if (!async) {
+    _enterPhase(phase);
+    AC_METRICS(_metrics.endScan());
+    AC_TRACE(AC_TRACEID_SCANEND, sc, 0);
+    AC_EVENTS(AutoConnectEvents::push(PSTR("scan"), sc));
+    AC_DBG("Scan ch:%d %lums\n", (int)ch, millis() - tm);
+  }
+  return sc;
+}
+
+/**
+ *  Aims a connectable access point by seeking with the WiFi scan results.
+ *  The collation uses the saved credentials, and the connection priority
+ *  follows AutoConnectConfig::principle.
+ *  Either BSSID or SSID of the collation key is determined at compile
+ *  time according to the AUTOCONNECT_APKEY_SSID definition.
+ *  @param  principle  WiFi connection principle.
+ *  @param  mode  Seek mode for whether to target a specific SSID.
+ *  @return true  A matched credential of BSSID was loaded.
+ */
+bool AutoConnect::_seekCredential(const AC_PRINCIPLE_t principle, const AC_SEEKMODE_t mode) {
+  AutoConnectCredential credential(_apConfig.boundaryOffset);
+  AutoConnectStats  stats;        // Connection statistics for AC_PRINCIPLE_LATENCY.
+  // Ranking of the matched credentials, the first is the best one.
+  struct {
+    uint8_t entry;                // Credential entry number
+    int32_t rssi;                 // Signal strength
+    unsigned long ttc;            // Expected time to connect
+  } rank[AUTOCONNECT_CANDIDATES];
+  uint8_t ranks = 0;
+
+  // Determine whether the candidate has priority over the ranked one
+  // according to the WiFi connection principle. AC_PRINCIPLE_RECENT
+  // keeps the order of the scan result.
+  auto isPrior = [principle](const int32_t rssi, const unsigned long ttc, const int32_t rankedRssi, const unsigned long rankedTtc) {
+    switch (principle) {
+    case AC_PRINCIPLE_RSSI:
+      return rssi > rankedRssi;
+    case AC_PRINCIPLE_LATENCY:
+      return ttc < rankedTtc || (ttc == rankedTtc && rssi > rankedRssi);
+    default:
+      return false;
+    }
+  };
+
+  // Seek SSID
+  _candidateCount = _candidateNext = 0;
+  const char* currentSSID = WiFi.SSID().c_str();
   for (uint8_t n = 0; n < WiFi.scanComplete(); n++) {
     if (mode == AC_SEEKMODE_CURRENT) {
       // It finds a specific access point that matches the SSID
@@ -942,25 +1823,39 @@ bool AutoConnect::_seekCredential(const AC_PRINCIPLE_t principle, const AC_SEEKM
         if (_isValidAP(_credential, n)) {
           if ((mode == AC_SEEKMODE_NEWONE) && (strlen(currentSSID) > 0))
             continue;
-          if (WiFi.RSSI(n) < _apConfig.minRSSI) {
+          int32_t rssi = WiFi.RSSI(n);
+          if (rssi < _apConfig.minRSSI) {
             // Excepts SSID that has weak RSSI under the lower limit.
-            AC_DBG("%s:%" PRId32 "dBm, rejected\n", reinterpret_cast<const char*>(_credential.ssid), WiFi.RSSI(n));
+            AC_DBG("%s:%" PRId32 "dBm, rejected\n", reinterpret_cast<const char*>(_credential.ssid), rssi);
             continue;
           }
-          // Determine valid credential
-          switch (principle) {
-          case AC_PRINCIPLE_RECENT:
-            // By BSSID, exit to keep the credential just loaded.
-            return true;
+          unsigned long ttc = principle == AC_PRINCIPLE_LATENCY ? stats.expect(_credential, _apConfig.beginTimeout) : 0;
+
+          // A credential that matches the multiple access points with
+          // the same SSID takes the better rank.
+          uint8_t r = 0;
+          while (r < ranks && rank[r].entry != i)
+            r++;
+          if (r < ranks) {
+            if (!isPrior(rssi, ttc, rank[r].rssi, rank[r].ttc))
+              break;
+            memmove(&rank[r], &rank[r + 1], (ranks - r - 1) * sizeof(rank[0]));
+            ranks--;
+          }
 
-          case AC_PRINCIPLE_RSSI:
-            // Verify that most strong radio signal.
-            // Continue seeking to find the strongest WIFI signal SSID.
-            if (WiFi.RSSI(n) > minRSSI) {
-              minRSSI = WiFi.RSSI(n);
-              memcpy(&validConfig, &_credential, sizeof(station_config_t));
-            }
-            break;
+          // Insert the credential into the ranking, the lowest one is
+          // dropped when the ranking is full.
+          r = ranks;
+          while (r > 0 && isPrior(rssi, ttc, rank[r - 1].rssi, rank[r - 1].ttc))
+            r--;
+          if (r < AUTOCONNECT_CANDIDATES) {
+            if (ranks == AUTOCONNECT_CANDIDATES)
+              ranks--;
+            memmove(&rank[r + 1], &rank[r], (ranks - r) * sizeof(rank[0]));
+            rank[r].entry = i;
+            rank[r].rssi = rssi;
+            rank[r].ttc = ttc;
+            ranks++;
           }
           break;
         }
@@ -968,53 +1863,115 @@ bool AutoConnect::_seekCredential(const AC_PRINCIPLE_t principle, const AC_SEEKM
     }
   }
 
-  // Increasing the minSSI will indicate the successfully sought for AC_PRINCIPLE_RSSI.
-  // Restore the credential that has maximum RSSI.
-  if (minRSSI > -120) {
-    memcpy(&_credential, &validConfig, sizeof(station_config_t));
+  // Restore the credential of the first rank. With the failover, the
+  // rest are retained as the candidates to be attempted in order.
+  if (ranks) {
+    credential.load(rank[0].entry, &_credential);
+    if (_apConfig.failover) {
+      for (uint8_t r = 1; r < ranks; r++)
+        _candidates[_candidateCount++] = rank[r].entry;
+      AC_DBG("%d candidate(s) retained\n", (int)_candidateCount);
+    }
     return true;
   }
   return false;
 }
 
+/**
+ *  Load the next candidate credential ranked by _seekCredential. The
+ *  candidates are retained only with AutoConnectConfig::failover.
+ *  @param  ssid      A pointer to the buffer that SSID should be stored.
+ *  @param  password  A pointer to the buffer that password should be stored.
+ *  @return true  The next candidate loaded.
+ *  @return false No more candidates.
+ */
+bool AutoConnect::_loadNextCredential(char* ssid, char* password) {
+  AutoConnectCredential credential(_apConfig.boundaryOffset);
+
+  while (_candidateNext < _candidateCount) {
+    if (credential.load(_candidates[_candidateNext++], &_credential)) {
+      strcpy(ssid, reinterpret_cast<const char*>(_credential.ssid));
+      strcpy(password, reinterpret_cast<const char*>(_credential.password));
+      return true;
+    }
+  }
+  return false;
+}
+
 /**
  *  Changes WiFi mode to enable SoftAP and configure IPs with current
  *  AutoConnectConfig settings then start SoftAP.
  */
 void AutoConnect::_softAP(void) {
-  WiFi.enableAP(true);
-  while (!(WiFi.getMode() & WIFI_AP)) {
-    delay(1);
-    yield();
-  }
+  _enterPhase(AC_BOOTPHASE_SOFTAP);
+  _softAPPhase = 0;
+  _waitForEvent([this]() {
+    return _advanceSoftAP();
+  }, 0, false);
+}
 
+/**
+ *  Advance the SoftAP activation by one step without blocking. The
+ *  progress is kept with _softAPPhase which should be 0 at the start.
+ *  @return true  SoftAP is active with the configured IP.
+ *  @return false SoftAP activation is in progress.
+ */
+bool AutoConnect::_advanceSoftAP(void) {
+  switch (_softAPPhase) {
+  case 0:
+    WiFi.enableAP(true);
+    _softAPPhase++;
+    // fall through
+  case 1:
+    if (!(WiFi.getMode() & WIFI_AP))
+      return false;
 #if defined(ARDUINO_ARCH_ESP8266)
-  _configAP();
+    _configAP();
 #endif
-
-  WiFi.softAP(_apConfig.apid.c_str(), _apConfig.psk.c_str(), _apConfig.channel, _apConfig.hidden);
-  do {
-    delay(100);
-    yield();
-  } while (!WiFi.softAPIP());
-
+    WiFi.softAP(_apConfig.apid.c_str(), _apConfig.psk.c_str(), _apConfig.channel, _apConfig.hidden);
+    _stateEntry = millis();
+    _softAPPhase++;
+    return false;
+  case 2:
+    // Allow SoftAP a while to bring up the interface.
+    if (millis() - _stateEntry < 100 || !WiFi.softAPIP())
+      return false;
 #if defined(ARDUINO_ARCH_ESP32)
-  _configAP();
+    _configAP();
 #endif
-
-  if (_apConfig.apip) {
-    do {
-      delay(100);
-      yield();
-    } while (WiFi.softAPIP() != _apConfig.apip);
+    _softAPPhase++;
+    // fall through
+  case 3:
+    if (_apConfig.apip) {
+      if (WiFi.softAPIP() != _apConfig.apip)
+        return false;
+    }
+    break;
   }
+  _softAPPhase = 0;
   AC_DBG("SoftAP %s/%s Ch(%d) IP:%s %s\n", _apConfig.apid.c_str(), _apConfig.psk.c_str(), _apConfig.channel, WiFi.softAPIP().toString().c_str(), _apConfig.hidden ? "hidden" : "");
+  return true;
 }
 
+/**
+ *  The connectivity probes of the client OSs. While the captive portal
+ *  is open, each of them is answered by the precomputed redirection to
+ *  the portal, which any of the OSs regards as the captive network.
+ */
+const char* const AutoConnect::_probeUris[] = {
+  "/generate_204",          // Android, ChromeOS
+  "/hotspot-detect.html",   // iOS, macOS
+  "/ncsi.txt",              // Windows before 10
+  "/connecttest.txt",       // Windows 10 or later
+  "/success.txt",           // Firefox
+  "/canonical.html"         // Firefox, Ubuntu
+};
+
 /**
  *  Starts Web server for AutoConnect service.
  */
 void AutoConnect::_startWebServer(void) {
+  _enterPhase(AC_BOOTPHASE_WEBSERVER);
   // Boot Web server
   if (!_webServer) {
     // Only when hosting WebServer internally
@@ -1026,10 +1983,31 @@ void AutoConnect::_startWebServer(void) {
   _webServer->onNotFound(std::bind(&AutoConnect::_handleNotFound, this));
   // here, Prepare PageBuilders for captive portal
   if (!_responsePage) {
+    // The web server tries the handlers in the order of registration.
+    // The connectivity probes are registered ahead of the PageBuilder,
+    // so that they are answered before _classifyHandle evaluates them
+    // and without discarding the cached page.
+    for (const char* probe : _probeUris)
+      _webServer->on(probe, std::bind(&AutoConnect::_handleProbe, this));
     _responsePage.reset( new PageBuilder() );
     _responsePage->exitCanHandle(std::bind(&AutoConnect::_classifyHandle, this, std::placeholders::_1, std::placeholders::_2));
     _responsePage->onUpload(std::bind(&AutoConnect::_handleUpload, this, std::placeholders::_1, std::placeholders::_2));
     _responsePage->insert(*_webServer);
+#ifdef AUTOCONNECT_USE_METRICS
+    _webServer->on(AUTOCONNECT_URI_METRICS, std::bind(&AutoConnect::_handleMetrics, this));
+#endif
+#ifdef AUTOCONNECT_USE_TRACE
+    _webServer->on(AUTOCONNECT_URI_TRACE, std::bind(&AutoConnect::_handleTrace, this));
+#endif
+#ifdef AUTOCONNECT_USE_STREAMCONFIG
+    _webServer->on(AUTOCONNECT_URI_CONFIG, std::bind(&AutoConnect::_handleConfig, this));
+#endif
+#ifdef AUTOCONNECT_USE_JSONAPI
+    _insertApi();
+#endif
+#ifdef AUTOCONNECT_USE_EVENTS
+    _webServer->on(AUTOCONNECT_URI_EVENTS, HTTP_GET, std::bind(&AutoConnect::_handleSubscribe, this));
+#endif
 
     _webServer->begin();
     AC_DBG("http server started\n");
@@ -1043,11 +2021,15 @@ void AutoConnect::_startWebServer(void) {
  *  Starts DNS server for Captive portal.
  */
 void AutoConnect::_startDNSServer(void) {
+  _enterPhase(AC_BOOTPHASE_DNS);
   // Boot DNS server, set up for captive portal redirection.
   if (!_dnsServer) {
-    _dnsServer.reset(new DNSServer());
-    _dnsServer->setErrorReplyCode(DNSReplyCode::NoError);
-    _dnsServer->start(AUTOCONNECT_DNSPORT, "*", WiFi.softAPIP());
+    _dnsServer.reset(new AutoConnectDNS());
+    _dnsServer->start(AUTOCONNECT_DNSPORT, WiFi.softAPIP());
+    // The response to the connectivity probes is the shortest redirection
+    // to the portal, it is built once while the DNS server is running.
+    _probeResponse = String(F("HTTP/1.1 302 Found\r\nLocation: http://")) + WiFi.softAPIP().toString() + _getBootUri() + String(F("\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"));
+    AC_TRACE(AC_TRACEID_PORTALSTART, static_cast<uint32_t>(WiFi.softAPIP()), 0);
     AC_DBG("DNS server started\n");
   }
 }
@@ -1060,6 +2042,7 @@ void AutoConnect::_stopDNSServer(void) {
   if (_dnsServer) {
     _dnsServer->stop();
     _dnsServer.reset();
+    _probeResponse = String();
     AC_DBG("DNS server stopped\n");
   }
 }
@@ -1073,11 +2056,17 @@ void AutoConnect::_stopPortal(void) {
 
   if (_webServer) {
     _webServer->client().stop();
-    delay(1000);
+    // Allow the client a while to leave. beginAsync does not wait for it.
+    if (!_isBeginInProgress()) {
+      _waitForEvent([this]() {
+        return !_webServer->client().connected();
+      }, 1000, false);
+    }
   }
 
   _setReconnect(AC_RECONNECT_RESET);
   WiFi.softAPdisconnect(false);
+  AC_TRACE(AC_TRACEID_PORTALSTOP, 0, 0);
   AC_DBG("Portal stopped\n");
 }
 
@@ -1129,11 +2118,94 @@ bool AutoConnect::_hasTimeout(unsigned long timeout) {
   return (millis() - _portalAccessPeriod > timeout) ? true : false;
 }
 
+/**
+ *  Reflects the result of the connection attempt requested from the
+ *  portal. If the connection is established, it saves the credential
+ *  and releases the captive portal, otherwise the redirection to the
+ *  failure page is indicated.
+ */
+void AutoConnect::_handleConnectResult(void) {
+  if (_rsConnect == WL_CONNECTED) {
+    // WLAN successfully connected then release the DNS server.
+    // Also, stop WIFI_AP if retainPortal not specified.
+    _stopDNSServer();
+    if (!_apConfig.retainPortal) {
+      WiFi.softAPdisconnect(true);
+      WiFi.enableAP(false);
+    }
+    else {
+      AC_DBG("Maintain SoftAP\n");
+    }
+
+    // It will automatically save the credential which was able to
+    // establish current connection.
+    if (WiFi.BSSID() != NULL) {
+      memcpy(_credential.bssid, WiFi.BSSID(), sizeof(station_config_t::bssid));
+      _currentHostIP = WiFi.localIP();
+      _redirectURI = String(F(AUTOCONNECT_URI_SUCCESS));
+
+      // Save current credential
+      if (_apConfig.autoSave == AC_SAVECREDENTIAL_AUTO) {
+        AutoConnectCredential credit(_apConfig.boundaryOffset);
+        if (credit.save(&_credential)) {
+          AC_METRICS(_metrics.commit());
+          AC_TRACE(AC_TRACEID_COMMIT, true, 0);
+          AC_DBG("%.*s credential saved\n", sizeof(_credential.ssid), reinterpret_cast<const char*>(_credential.ssid));
+        }
+        else {
+          AC_DBG("credential %.*s save failed\n", sizeof(_credential.ssid), reinterpret_cast<const char*>(_credential.ssid));
+        }
+      }
+
+      // Ensures that keeps a connection with the current AP
+      // while the portal behaves.
+      _setReconnect(AC_RECONNECT_SET);
+    }
+    else {
+      AC_DBG("%.*s has no BSSID, saving is unavailable\n", sizeof(_credential.ssid), reinterpret_cast<const char*>(_credential.ssid));
+    }
+
+    // Activate AutoConnectUpdate if it is attached and incorporate
+    // it into the AutoConnect menu.
+    if (_update)
+      _update->enable();
+  }
+  else {
+    _currentHostIP = WiFi.softAPIP();
+    _redirectURI = String(F(AUTOCONNECT_URI_FAIL));
+    _disconnectWiFi(false);
+    // beginAsync leaves the status to settle without waiting.
+    if (_beginState != AC_BEGINSTATE_PORTALCONNECT) {
+      wl_status_t wl;
+      _waitForEvent([&wl]() {
+        wl = WiFi.status();
+        return wl == WL_IDLE_STATUS || wl == WL_DISCONNECTED || wl == WL_NO_SSID_AVAIL;
+      }, 3000, false);
+      AC_DBG("Quit connecting, status(%d)\n", wl);
+    }
+  }
+}
+
 /**
  *  A handler that redirects access to the captive portal to the connection
  *  configuration page.
  */
 void AutoConnect::_handleNotFound(void) {
+  AC_HEAPTRACE_ROUTE(_webServer->uri().c_str());
+  AC_METRICS(_markRequest(AC_METRICSROUTE_NOTFOUND));
+  if (_lowMemory) {
+    if (_webServer->uri() == String(AUTOCONNECT_URI)) {
+      // The statistics page is the captive portal's landing and probe
+      // target; it is turned to the configuration page.
+      _webServer->sendHeader(String(F("Location")), String(F(AUTOCONNECT_URI_CONFIG)), true);
+      _webServer->send(302, String(F("text/plain")), _emptyString);
+      return;
+    }
+    if (_isLowPriority(_webServer->uri())) {
+      _rejectRequest();
+      return;
+    }
+  }
   if (!_captivePortal()) {
     if (_notFoundHandler) {
       _notFoundHandler();
@@ -1146,10 +2218,157 @@ void AutoConnect::_handleNotFound(void) {
       _webServer->sendHeader(String(F("Expires")), String("-1"));
       _webServer->sendHeader(String(F("Content-Length")), String(html.length()));
       _webServer->send(404, String(F("text/html")), html);
+      AC_METRICS(_markRequest(AC_METRICSROUTE_NOTFOUND, html.length()));
     }
   }
 }
 
+/**
+ *  Respond to the connectivity probe of the client OS. While the captive
+ *  portal is open, the precomputed redirection is written to the client
+ *  directly. Otherwise it is the same as the URI not found.
+ */
+void AutoConnect::_handleProbe(void) {
+  if (!_probeResponse.length()) {
+    _handleNotFound();
+    return;
+  }
+  AC_DBG("Probe %s\n", _webServer->uri().c_str());
+  AC_HEAPTRACE_ROUTE(_webServer->uri().c_str());
+  AC_METRICS(_markRequest(AC_METRICSROUTE_PROBE, _probeResponse.length()));
+  _portalAccessPeriod = millis();
+  _pending |= AC_PENDING_REQUEST;
+  WiFiClient  client = _webServer->client();
+  client.write(reinterpret_cast<const uint8_t*>(_probeResponse.c_str()), _probeResponse.length());
+  client.flush();
+  client.stop();
+}
+
+#ifdef AUTOCONNECT_USE_METRICS
+/**
+ *  Respond the metrics in the Prometheus text format, or in JSON if
+ *  the format=json argument is given.
+ */
+void AutoConnect::_handleMetrics(void) {
+  if (_evalMemory()) {
+    _rejectRequest();
+    return;
+  }
+  bool  json = _webServer->arg(String(F("format"))) == String(F("json"));
+  AC_HEAPTRACE_ROUTE(AUTOCONNECT_URI_METRICS);
+  String  body = json ? _metrics.toJson() : _metrics.toPrometheus();
+#ifdef AC_HEAPTRACE
+  if (!json)
+    body += AutoConnectHeapTrace::toPrometheus();
+#endif
+  _markRequest(AC_METRICSROUTE_METRICS, body.length());
+  _webServer->sendHeader(String(F("Cache-Control")), String(F("no-cache, no-store, must-revalidate")), true);
+  _webServer->send(200, json ? String(F("application/json")) : String(F("text/plain; version=0.0.4")), body);
+}
+
+/**
+ *  Mark the route of the request in progress, which will be recorded
+ *  by _recordRequest after the web server has responded. The first
+ *  mark in a request wins the route, and the bytes are accumulated.
+ *  @param  route   Route of the request.
+ *  @param  bytes   Size of the response sent directly.
+ */
+void AutoConnect::_markRequest(const AC_METRICSROUTE_t route, const uint32_t bytes) {
+  if (_requestRoute == AC_METRICSROUTE_NONE) {
+    _requestRoute = route;
+    _requestStart = millis();
+    _requestBytes = 0;
+  }
+  _requestBytes += bytes;
+}
+
+/**
+ *  Record the request marked while the web server was handling it.
+ */
+void AutoConnect::_recordRequest(void) {
+  if (_requestRoute != AC_METRICSROUTE_NONE) {
+    _metrics.request(_requestRoute, millis() - _requestStart, _requestBytes);
+    _metrics.sampleHeap();
+    AC_ARENA(_metrics.arena(_requestRoute, AutoConnectArena::peak()));
+    _requestRoute = AC_METRICSROUTE_NONE;
+  }
+}
+#endif // !AUTOCONNECT_USE_METRICS
+
+#ifdef AUTOCONNECT_USE_ARENA
+/**
+ *  Release the scratch buffers taken while the web server was handling
+ *  the request. The response has been sent, so no buffer is alive.
+ */
+void AutoConnect::_releaseArena(void) {
+  if (AutoConnectArena::peak())
+    AC_DBG("Arena %s peak %u/%u\n", _webServer->uri().c_str(), static_cast<unsigned int>(AutoConnectArena::peak()), (unsigned int)AUTOCONNECT_ARENA_SIZE);
+  AutoConnectArena::close();
+}
+#endif // !AUTOCONNECT_USE_ARENA
+
+#ifdef AUTOCONNECT_USE_TRACE
+/**
+ *  Respond the records of the trace ring buffer in binary for the
+ *  decoder, or in text if the format=text argument is given.
+ */
+void AutoConnect::_handleTrace(void) {
+  if (_evalMemory()) {
+    _rejectRequest();
+    return;
+  }
+  _webServer->sendHeader(String(F("Cache-Control")), String(F("no-cache, no-store, must-revalidate")), true);
+  if (_webServer->arg(String(F("format"))) == String(F("text"))) {
+    _webServer->send(200, String(F("text/plain")), AutoConnectTrace::toText());
+    return;
+  }
+  uint16_t  count = AutoConnectTrace::available();
+  _webServer->setContentLength(sizeof(AC_TRACEHEADER_t) + count * sizeof(AC_TRACEREC_t));
+  _webServer->send(200, String(F("application/octet-stream")), _emptyString);
+  WiFiClient  client = _webServer->client();
+  AutoConnectTrace::dump(client, count);
+}
+#endif // !AUTOCONNECT_USE_TRACE
+
+#ifdef AUTOCONNECT_USE_EVENTS
+/**
+ *  Push the connection state when it has changed, as long as any
+ *  browser subscribes to the event stream.
+ */
+void AutoConnect::_handleEvents(void) {
+  if (!AutoConnectEvents::handle())
+    return;
+  if (WiFi.status() != _eventStatus || _isConnectInProgress() != _eventConnecting)
+    _pushStatus();
+}
+
+/**
+ *  Subscribe the client to the event stream. The current connection
+ *  state is pushed at first, then the changes follow.
+ */
+void AutoConnect::_handleSubscribe(void) {
+  if (!_authenticateRequest())
+    return;
+  WiFiClient  client = _webServer->client();
+  if (!AutoConnectEvents::subscribe(client)) {
+    _webServer->send(503, String(F("text/plain")), String(F("503 Service Unavailable")));
+    return;
+  }
+  _pushStatus();
+}
+
+/**
+ *  Push the connection state as the status event.
+ */
+void AutoConnect::_pushStatus(void) {
+  _eventStatus = WiFi.status();
+  _eventConnecting = _isConnectInProgress();
+  char  data[80];
+  snprintf_P(data, sizeof(data), PSTR("{\"status\":%d,\"connecting\":%s,\"ip\":\"%s\"}"), static_cast<int>(_eventStatus), _eventConnecting ? "true" : "false", WiFi.localIP().toString().c_str());
+  AutoConnectEvents::push(PSTR("status"), data);
+}
+#endif // !AUTOCONNECT_USE_EVENTS
+
 /**
  *  Reset the ESP8266 module.
  *  It is called from the PageBuilder of the disconnect page and indicates
@@ -1173,14 +2392,12 @@ String AutoConnect::_induceDisconnect(PageArgument& args) {
 }
 
 /**
- *  Indicates a connection establishment request and returns a redirect
- *  response to the waiting for connection page. This is called from
- *  handling of the current request by PageBuilder triggered by handleClient().
- *  If "Credential" exists in POST parameter, it reads from EEPROM.
- *  @param  args  http request arguments.
- *  @return A redirect response including "Location:" header.
+ *  Accept the credential to be connected from the request arguments,
+ *  and determine the channel of the connection.
+ *  @param  args  Request arguments, PageArgument or the web server.
  */
-String AutoConnect::_induceConnect(PageArgument& args) {
+template<typename T>
+void AutoConnect::_acceptCredential(T& args) {
   // Retrieve credential from the post method content.
   if (args.hasArg(String(F(AUTOCONNECT_PARAMID_CRED)))) {
     // Read from EEPROM
@@ -1192,7 +2409,7 @@ String AutoConnect::_induceConnect(PageArgument& args) {
 #endif
   }
   else {
-    AC_DBG("Queried SSID:%s\n", args.arg(AUTOCONNECT_PARAMID_SSID).c_str());
+    AC_DBG("Queried SSID:%s\n", args.arg(String(F(AUTOCONNECT_PARAMID_SSID))).c_str());
     // Credential had by the post parameter.
     strncpy(reinterpret_cast<char*>(_credential.ssid), args.arg(String(F(AUTOCONNECT_PARAMID_SSID))).c_str(), sizeof(_credential.ssid));
     strncpy(reinterpret_cast<char*>(_credential.password), args.arg(String(F(AUTOCONNECT_PARAMID_PASS))).c_str(), sizeof(_credential.password));
@@ -1236,8 +2453,34 @@ String AutoConnect::_induceConnect(PageArgument& args) {
       break;
     }
   }
+}
 
-  // Turn on the trigger to start WiFi.begin().
+#ifdef AUTOCONNECT_USE_JSONAPI
+// The connection request of the JSON API takes the arguments from the
+// web server.
+template void AutoConnect::_acceptCredential<WebServerClass>(WebServerClass& args);
+#endif // !AUTOCONNECT_USE_JSONAPI
+
+/**
+ *  Indicates a connection establishment request and returns a redirect
+ *  response to the waiting for connection page. This is called from
+ *  handling of the current request by PageBuilder triggered by handleClient().
+ *  If "Credential" exists in POST parameter, it reads from EEPROM.
+ *  @param  args  http request arguments.
+ *  @return A redirect response including "Location:" header.
+ */
+String AutoConnect::_induceConnect(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_induceConnect");
+  // The connection attempt in progress keeps its credential, the client
+  // will be shown its result.
+  if (_rfWaiting)
+    return _emptyString;
+
+  _acceptCredential(args);
+
+  // Turn on the trigger to start WiFi.begin(). The connection requested
+  // from the portal does not fail over to the candidates.
+  _candidateCount = _candidateNext = 0;
   _rfConnect = true;
 
 // Since v0.9.7, the redirect method changed from a 302 response to the
@@ -1274,6 +2517,14 @@ String AutoConnect::_induceConnect(PageArgument& args) {
  */
 String AutoConnect::_invokeResult(PageArgument& args) {
   AC_UNUSED(args);
+  // The connection attempt by beginAsync or being waited for has not
+  // concluded yet, let the client request the result again after a while.
+  if (_beginState == AC_BEGINSTATE_PORTALCONNECT || _rfWaiting) {
+    _webServer->sendHeader(String(F("Refresh")), String(F("1;url=" AUTOCONNECT_URI_RESULT)));
+    _webServer->send(200, String(F("text/html")), _emptyString);
+    _responsePage->cancel();
+    return _emptyString;
+  }
   String redirect = String(F("http://"));
   // The host address to which the connection result for ESP32 responds
   // changed from v0.9.7. This change is a measure according to the
@@ -1308,11 +2559,37 @@ String AutoConnect::_invokeResult(PageArgument& args) {
 bool AutoConnect::_classifyHandle(HTTPMethod method, String uri) {
   AC_UNUSED(method);
   _portalAccessPeriod = millis();
-  AC_DBG("Host:%s,%s", _webServer->hostHeader().c_str(), uri.c_str());
+  _pending |= AC_PENDING_REQUEST;
+  AC_TDBG("Host:%s,%s", _webServer->hostHeader().c_str(), uri.c_str());
+  AC_HEAPTRACE_ROUTE(uri.c_str());
+  AC_TRACE(AC_TRACEID_REQUEST, method, AutoConnectTrace::hash(uri.c_str()));
+
+  // Under the memory pressure, the pages not needed to establish the
+  // connection are refused and the statistics page is redirected to
+  // the configuration page. _handleNotFound answers them.
+  if (_evalMemory() && (_isLowPriority(uri) || uri == String(AUTOCONNECT_URI))) {
+    _purgePages();
+    AC_TRACE(AC_TRACEID_CLASSIFY, _isLowPriority(uri) ? AC_TRACECLASSIFY_REFUSED : AC_TRACECLASSIFY_REDIRECTED, 0);
+    AC_TDBG_DUMB(",%s\n", _isLowPriority(uri) ? "refused" : "redirected");
+    return false;
+  }
+
+#ifdef AUTOCONNECT_USE_STREAMCONFIG
+  // The configuration page is streamed by _handleConfig without the
+  // page of PageBuilder.
+  if (uri == String(AUTOCONNECT_URI_CONFIG)) {
+    _purgePages();
+    AC_TRACE(AC_TRACEID_CLASSIFY, AC_TRACECLASSIFY_STREAMED, 0);
+    AC_TDBG_DUMB(",streamed\n");
+    return false;
+  }
+#endif // !AUTOCONNECT_USE_STREAMCONFIG
 
   // Here, classify requested uri
   if (uri == _uri) {
-    AC_DBG_DUMB(",already allocated\n");
+    AC_TRACE(AC_TRACEID_CLASSIFY, AC_TRACECLASSIFY_CACHED, 0);
+    AC_TDBG_DUMB(",already allocated\n");
+    AC_METRICS(_markRequest(AutoConnectMetrics::classify(uri)));
     return true;  // The response page already exists.
   }
 
@@ -1329,12 +2606,14 @@ bool AutoConnect::_classifyHandle(HTTPMethod method, String uri) {
   }
 
   if (_currentPageElement) {
-    AC_DBG_DUMB(",generated:%s", uri.c_str());
+    AC_TDBG_DUMB(",generated:%s", uri.c_str());
     _uri = uri;
     _responsePage->addElement(*_currentPageElement);
     _responsePage->setUri(_uri.c_str());
+    AC_METRICS(_markRequest(AutoConnectMetrics::classify(uri)));
   }
-  AC_DBG_DUMB(",%s\n", _currentPageElement != nullptr ? " allocated" : "ignored");
+  AC_TRACE(AC_TRACEID_CLASSIFY, _currentPageElement != nullptr ? AC_TRACECLASSIFY_GENERATED : AC_TRACECLASSIFY_IGNORED, 0);
+  AC_TDBG_DUMB(",%s\n", _currentPageElement != nullptr ? " allocated" : "ignored");
   return _currentPageElement != nullptr ? true : false;
 }
 
@@ -1364,6 +2643,41 @@ void AutoConnect::_purgePages(void) {
   }
 }
 
+/**
+ *  Evaluate the free heap and the largest free block against the
+ *  watermarks, and determine the low memory mode for the request.
+ *  @return true  The request is served in the low memory mode.
+ */
+bool AutoConnect::_evalMemory(void) {
+  bool  low = ESP.getFreeHeap() < _apConfig.heapWatermark || _getMaxFreeBlock() < _apConfig.blockWatermark;
+  if (low != _lowMemory)
+    AC_DBG("Low memory mode %s, heap:%u\n", low ? "entered" : "left", ESP.getFreeHeap());
+  _lowMemory = low;
+  return _lowMemory;
+}
+
+/**
+ *  The pages which are not needed to establish the connection are the
+ *  low priority, they are refused in the low memory mode. The metrics
+ *  and the trace endpoints refuse by themselves, and the statistics
+ *  page is redirected instead since it is the captive portal target.
+ *  @param  uri   Requested URI.
+ *  @return true  The page is the low priority.
+ */
+bool AutoConnect::_isLowPriority(const String& uri) const {
+  return uri == String(AUTOCONNECT_URI_OPEN);
+}
+
+/**
+ *  Refuse the request with 503 in the low memory mode. The response is
+ *  a short literal so that it does not need the heap to be built.
+ */
+void AutoConnect::_rejectRequest(void) {
+  AC_DBG("%s refused by low memory\n", _webServer->uri().c_str());
+  _webServer->sendHeader(String(F("Retry-After")), String(AUTOCONNECT_LOWMEMORY_RETRY));
+  _webServer->send(503, String(F("text/plain")), String(F("503 Service Unavailable")));
+}
+
 /**
  *  It checks whether the specified character string is a valid IP address.
  *  @param  ipStr   IP string for validation.
@@ -1413,6 +2727,87 @@ unsigned int AutoConnect::_toWiFiQuality(int32_t rssi) {
   return qu;
 }
 
+/**
+ *  Concludes the connection attempt. It records the result to the
+ *  connection statistics and calls the exit routine for onConnect.
+ *  @param  wifiStatus  WiFi status as the result of the attempt.
+ *  @param  elapsed     Time taken by the attempt [ms].
+ */
+void AutoConnect::_settleConnect(const wl_status_t wifiStatus, const unsigned long elapsed) {
+  AC_TDBG_DUMB("%s IP:%s\n", wifiStatus == WL_CONNECTED ? "established" : "time out", WiFi.localIP().toString().c_str());
+  AC_METRICS(_metrics.connect(wifiStatus == WL_CONNECTED, elapsed));
+  AC_TRACE(AC_TRACEID_SETTLE, wifiStatus, elapsed);
+  if (_rfProfiling && wifiStatus == WL_CONNECTED)
+    _bootProfile.toConnected = micros() - _profileStart;
+
+  // Record the result of this attempt to the connection statistics.
+  // The established AP is identified by the actual BSSID, the failed one
+  // is identified by the credential that was attempted.
+  AutoConnectStats  stats;
+  if (wifiStatus == WL_CONNECTED) {
+    station_config_t  established;
+    memset(&established, 0x00, sizeof(station_config_t));
+    strncpy(reinterpret_cast<char*>(established.ssid), WiFi.SSID().c_str(), sizeof(station_config_t::ssid));
+    if (WiFi.BSSID())
+      memcpy(established.bssid, WiFi.BSSID(), sizeof(station_config_t::bssid));
+    stats.record(established, true, elapsed, static_cast<uint8_t>(WiFi.channel()));
+  }
+  else
+    stats.record(_credential, false, elapsed);
+
+  // Cache the lease of the established connection for the next fast
+  // reconnect. The lease that failed is discarded and the station falls
+  // back to the normal connection with the DHCP.
+  if (_apConfig.fastReconnect) {
+    AutoConnectLease  rtc;
+    if (wifiStatus == WL_CONNECTED) {
+      // The lease refers to the saved credential instead of holding the
+      // passphrase. The connection with a credential not saved yet is
+      // cached by the next one.
+      AutoConnectCredential credential(_apConfig.boundaryOffset);
+      station_config_t  saved;
+      int8_t  entry = credential.load(WiFi.SSID().c_str(), &saved);
+      memset(saved.password, 0x00, sizeof(station_config_t::password));
+      if (entry >= 0) {
+        AutoConnectLease_t  lease;
+        memset(&lease, 0x00, sizeof(AutoConnectLease_t));
+        lease.ssidHash = AutoConnectLease::hash(saved.ssid);
+        lease.entry = static_cast<uint8_t>(entry);
+        if (WiFi.BSSID())
+          memcpy(lease.bssid, WiFi.BSSID(), sizeof(AutoConnectLease_t::bssid));
+        lease.channel = static_cast<uint8_t>(WiFi.channel());
+        lease.uses = _rfFastReconnect ? _leaseUses + 1 : 0;
+        lease.ip = static_cast<uint32_t>(WiFi.localIP());
+        lease.gateway = static_cast<uint32_t>(WiFi.gatewayIP());
+        lease.netmask = static_cast<uint32_t>(WiFi.subnetMask());
+        lease.dns1 = static_cast<uint32_t>(WiFi.dnsIP(0));
+        lease.dns2 = static_cast<uint32_t>(WiFi.dnsIP(1));
+        rtc.save(&lease);
+        AC_TRACE(AC_TRACEID_LEASE, 1, entry);
+      }
+      else {
+        AC_TRACE(AC_TRACEID_LEASE, 0, entry);
+        AC_TDBG("Lease not cached, %s not saved\n", WiFi.SSID().c_str());
+        rtc.clear();
+      }
+    }
+    else if (_rfFastReconnect) {
+      AC_TRACE(AC_TRACEID_LEASE, -1, 0);
+      AC_TDBG("Lease discarded\n");
+      rtc.clear();
+      _disconnectWiFi(false);
+    }
+  }
+  _rfFastReconnect = false;
+
+  if (WiFi.status() == WL_CONNECTED)
+    if (_onConnectExit) {
+      IPAddress localIP = WiFi.localIP();
+      _onConnectExit(localIP);
+    }
+  _attemptPeriod = millis();  // Save to measure the interval between an autoReconnect.
+}
+
 /**
  *  Wait for establishment of the connection until the specified time expires.
  *  @param  timeout Expiration time by millisecond unit.
@@ -1422,22 +2817,298 @@ wl_status_t AutoConnect::_waitForConnect(unsigned long timeout) {
   wl_status_t wifiStatus;
 
   unsigned long st = millis();
-  while ((wifiStatus = WiFi.status()) != WL_CONNECTED) {
-    if (timeout) {
-      if (millis() - st > timeout)
+  _waitForEvent([&wifiStatus]() {
+    return (wifiStatus = WiFi.status()) == WL_CONNECTED;
+  }, timeout);
+  _settleConnect(wifiStatus, millis() - st);
+  // A failed attempt is followed by loading the next credential.
+  if (wifiStatus != WL_CONNECTED)
+    _enterPhase(AC_BOOTPHASE_CREDENTIAL);
+  return wifiStatus;
+}
+
+/**
+ *  Register the WiFi event handlers that wake the waiter of
+ *  _waitForEvent as soon as the station state changes.
+ */
+void AutoConnect::_attachWaitEvents(void) {
+  if (_waitEventsAttached)
+    return;
+#if defined(ARDUINO_ARCH_ESP8266)
+  _gotIPHandler = WiFi.onStationModeGotIP([this](const WiFiEventStationModeGotIP& e) {
+    AC_UNUSED(e);
+    _postWiFiEvent(AC_WIFIEVENT_GOTIP);
+  });
+  _disconnectedHandler = WiFi.onStationModeDisconnected([this](const WiFiEventStationModeDisconnected& e) {
+    _postWiFiEvent(AC_WIFIEVENT_DISCONNECTED, e.reason);
+  });
+#elif defined(ARDUINO_ARCH_ESP32)
+  _wakeEventId = WiFi.onEvent([this](WiFiEvent_t e, WiFiEventInfo_t info) {
+    if (e == SYSTEM_EVENT_STA_GOT_IP)
+      _postWiFiEvent(AC_WIFIEVENT_GOTIP);
+    else if (e == SYSTEM_EVENT_STA_DISCONNECTED)
+      _postWiFiEvent(AC_WIFIEVENT_DISCONNECTED, info.disconnected.reason);
+    else
+      _wakeWaiter();
+  });
+#endif
+  _waitEventsAttached = true;
+}
+
+/**
+ *  Release the WiFi event handlers for _waitForEvent.
+ */
+void AutoConnect::_detachWaitEvents(void) {
+  if (!_waitEventsAttached)
+    return;
+#if defined(ARDUINO_ARCH_ESP8266)
+  _gotIPHandler.reset();
+  _disconnectedHandler.reset();
+#elif defined(ARDUINO_ARCH_ESP32)
+  WiFi.removeEvent(_wakeEventId);
+#endif
+  _waitEventsAttached = false;
+}
+
+/**
+ *  Acquire the ownership of AutoConnect against the dedicated portal
+ *  task. The sketch should enclose the AutoConnect API calls and the
+ *  access to AutoConnectElements in loop() between lock and unlock
+ *  while AutoConnectConfig::portalTask is enabled. It can be nested.
+ *  No effects on ESP8266.
+ */
+void AutoConnect::lock(void) {
+#ifdef ARDUINO_ARCH_ESP32
+  if (_taskLock)
+    xSemaphoreTakeRecursive(_taskLock, portMAX_DELAY);
+#endif
+}
+
+/**
+ *  Release the ownership acquired by lock.
+ */
+void AutoConnect::unlock(void) {
+#ifdef ARDUINO_ARCH_ESP32
+  if (_taskLock)
+    xSemaphoreGiveRecursive(_taskLock);
+#endif
+}
+
+/**
+ *  Start the dedicated portal task which runs handleClient instead of
+ *  loop() of the sketch. It is effective only for ESP32 with
+ *  AutoConnectConfig::portalTask enabled.
+ */
+void AutoConnect::_startTask(void) {
+#ifdef ARDUINO_ARCH_ESP32
+  if (!_apConfig.portalTask || _portalTask)
+    return;
+  if (!_taskLock) {
+    _taskLock = xSemaphoreCreateRecursiveMutex();
+    if (!_taskLock) {
+      AC_DBG("Portal task lock could not be created\n");
+      return;
+    }
+  }
+  _rfTaskStop = false;
+  if (xTaskCreatePinnedToCore(_portalTaskEntry, "AutoConnect", AUTOCONNECT_TASK_STACKSIZE, this, AUTOCONNECT_TASK_PRIORITY, &_portalTask, AUTOCONNECT_TASK_CORE) != pdPASS) {
+    _portalTask = nullptr;
+    AC_DBG("Portal task could not start\n");
+    return;
+  }
+  AC_DBG("Portal task started\n");
+#endif
+}
+
+/**
+ *  Stop the dedicated portal task and wait for its termination. If it
+ *  is called in the portal task itself, only the request is made and
+ *  the task terminates at the end of the current cycle.
+ */
+void AutoConnect::_stopTask(void) {
+#ifdef ARDUINO_ARCH_ESP32
+  if (!_portalTask)
+    return;
+  _rfTaskStop = true;
+  if (xTaskGetCurrentTaskHandle() == _portalTask)
+    return;
+  while (_portalTask)
+    delay(AUTOCONNECT_TASK_INTERVAL);
+  AC_DBG("Portal task stopped\n");
+#endif
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+/**
+ *  The dedicated portal task body. It runs handleClient holding the
+ *  lock so that the sketch can exclude it with AutoConnect::lock. The
+ *  lock is waited for a limited time to respond to the stop request
+ *  even while the sketch holds it.
+ *  @param  arg   AutoConnect instance.
+ */
+void AutoConnect::_portalTaskEntry(void* arg) {
+  AutoConnect*  ac = static_cast<AutoConnect*>(arg);
+
+  while (!ac->_rfTaskStop) {
+    if (xSemaphoreTakeRecursive(ac->_taskLock, pdMS_TO_TICKS(AUTOCONNECT_TASK_INTERVAL)) == pdTRUE) {
+      ac->handleClient();
+      xSemaphoreGiveRecursive(ac->_taskLock);
+    }
+    vTaskDelay(pdMS_TO_TICKS(AUTOCONNECT_TASK_INTERVAL));
+  }
+  ac->_portalTask = nullptr;
+  vTaskDelete(NULL);
+}
+#endif
+
+/**
+ *  Wake the waiter of _waitForEvent and handleRequest. It is called
+ *  from the WiFi event handler which runs in the context of the system
+ *  task.
+ */
+void AutoConnect::_wakeWaiter(void) {
+  // Let handleRequest take the full pass.
+  _pending |= AC_PENDING_WIFI;
+  if (!_rfWaiting)
+    return;
+#if defined(ARDUINO_ARCH_ESP8266)
+  // Resumes the loop task that is sleeping in delay.
+  esp_schedule();
+#elif defined(ARDUINO_ARCH_ESP32)
+  // The event group is dedicated to the waiter, the notification value
+  // of the waiting task is left to the others.
+  EventGroupHandle_t  waitEvents = _waitEvents;
+  if (waitEvents)
+    xEventGroupSetBits(waitEvents, AC_WAITEVENT_WAKE);
+#endif
+}
+
+/**
+ *  Convey the WiFi event to handleRequest. It is called from the WiFi
+ *  event handler, which is the only producer of the event queue. The
+ *  handler touches no other AutoConnect state, not even the trace.
+ *  @param  event   AC_WIFIEVENT_t
+ *  @param  reason  Reason of the disconnection.
+ *  @param  epoch   Registration epoch of the reconnect handler.
+ */
+void AutoConnect::_postWiFiEvent(const AC_WIFIEVENT_t event, const uint8_t reason, const uint8_t epoch) {
+  AC_WIFIEVENTREC_t rec;
+  rec.event = static_cast<uint8_t>(event);
+  rec.reason = reason;
+  rec.epoch = epoch;
+  rec.reserved = 0;
+  rec.time = millis();
+  _wifiEvents.push(rec);
+  _wakeWaiter();
+}
+
+/**
+ *  Drain the WiFi events queued by the event handlers and process them
+ *  in the order of occurrence. The reconnection requests are coalesced
+ *  into one, and a reconnection request followed by the IP acquisition
+ *  is discarded.
+ */
+void AutoConnect::_handleWiFiEvents(void) {
+  AC_WIFIEVENTREC_t rec;
+  bool  reconnect = false;
+
+  while (_wifiEvents.pop(rec)) {
+    // The trace is recorded here rather than in the event handler, the
+    // readers of the ring run on this task and need complete records.
+    AC_TRACE(AC_TRACEID_WIFIEVENT, rec.event, rec.reason);
+    switch (static_cast<AC_WIFIEVENT_t>(rec.event)) {
+    case AC_WIFIEVENT_GOTIP:
+      AC_TDBG("STA got IP at %lu\n", static_cast<unsigned long>(rec.time));
+      reconnect = false;
+      break;
+    case AC_WIFIEVENT_DISCONNECTED:
+      AC_TDBG("STA disconnected at %lu:%d\n", static_cast<unsigned long>(rec.time), static_cast<int>(rec.reason));
+      break;
+    case AC_WIFIEVENT_RECONNECT:
+#if defined(ARDUINO_ARCH_ESP32)
+      // The requests queued before the handler was released are stale.
+      if (_disconnectEventId == static_cast<WiFiEventId_t>(-1) || rec.epoch != _reconnectEpoch) {
+        AC_TDBG("STA reconnection discarded:%d\n", static_cast<int>(rec.reason));
         break;
+      }
+#endif
+      AC_TDBG("STA lost connection:%d\n", static_cast<int>(rec.reason));
+      reconnect = true;
+      break;
     }
-    AC_DBG_DUMB("%c", '.');
-    delay(300);
   }
-  AC_DBG_DUMB("%s IP:%s\n", wifiStatus == WL_CONNECTED ? "established" : "time out", WiFi.localIP().toString().c_str());
-  if (WiFi.status() == WL_CONNECTED)
-    if (_onConnectExit) {
-      IPAddress localIP = WiFi.localIP();
-      _onConnectExit(localIP);
+  if (reconnect) {
+    bool  rc = WiFi.reconnect();
+    AC_TRACE(AC_TRACEID_RECONNECT, rc, 0);
+    AC_TDBG("STA connection %s\n", rc ? "restored" : "failed");
+    AC_UNUSED(rc);
+  }
+
+#ifdef AC_DEBUG
+  static uint32_t reported = 0;
+  if (_wifiEvents.drops() != reported) {
+    reported = _wifiEvents.drops();
+    AC_DBG("WiFi events dropped:%lu, high water:%u\n", static_cast<unsigned long>(reported), static_cast<unsigned int>(_wifiEvents.highWater()));
+  }
+#endif
+}
+
+/**
+ *  Wait until the condition is satisfied. The waiter sleeps for up to
+ *  AUTOCONNECT_EVENT_SLICE, and the WiFi events registered with
+ *  _attachWaitEvents wake it up immediately. Meanwhile the DNS server
+ *  and the web server of the captive portal are serviced.
+ *  @param  condition A function that returns true when the wait ends.
+ *  It is evaluated once per slice and must not block.
+ *  @param  timeout   Time limit [ms], 0 means no limit.
+ *  @param  serve     Service the DNS server and the web server.
+ *  @return true      The condition is satisfied.
+ *  @return false     Timed out.
+ */
+bool AutoConnect::_waitForEvent(std::function<bool(void)> condition, const unsigned long timeout, const bool serve) {
+  bool  rc;
+  // The nested wait, which is invoked from the serviced page handler,
+  // does not service the server again.
+  bool  nested = _rfWaiting;
+
+  _attachWaitEvents();
+#if defined(ARDUINO_ARCH_ESP32)
+  if (!_waitEvents)
+    _waitEvents = xEventGroupCreate();
+  if (!nested && _waitEvents)
+    xEventGroupClearBits(_waitEvents, AC_WAITEVENT_WAKE);
+#endif
+  _rfWaiting = true;
+  unsigned long st = millis();
+  AC_TRACE(AC_TRACEID_WAITSTART, timeout, 0);
+  while (!(rc = condition())) {
+    if (timeout && millis() - st > timeout)
+      break;
+    if (serve && !nested) {
+      if (_dnsServer)
+        _dnsServer->processNextRequest();
+      if (_webServer && _responsePage)
+        _serveClient();
     }
-  _attemptPeriod = millis();  // Save to measure the interval between an autoReconnect.
-  return wifiStatus;
+#if defined(ARDUINO_ARCH_ESP8266)
+#ifdef AC_ESP_DELAY
+    esp_delay(AUTOCONNECT_EVENT_SLICE, [&condition]() {
+      return !condition();
+    });
+#else
+    delay(AUTOCONNECT_EVENT_SLICE);
+#endif
+#elif defined(ARDUINO_ARCH_ESP32)
+    if (_waitEvents)
+      xEventGroupWaitBits(_waitEvents, AC_WAITEVENT_WAKE, pdTRUE, pdFALSE, pdMS_TO_TICKS(AUTOCONNECT_EVENT_SLICE));
+    else
+      delay(AUTOCONNECT_EVENT_SLICE);
+#endif
+  }
+  AC_TRACE(AC_TRACEID_WAITEND, rc, millis() - st);
+  if (!nested)
+    _rfWaiting = false;
+  return rc;
 }
 
 /**
@@ -1449,17 +3120,29 @@ wl_status_t AutoConnect::_waitForConnect(unsigned long timeout) {
 void AutoConnect::_setReconnect(const AC_STARECONNECT_t order) {
 #if defined(ARDUINO_ARCH_ESP32)
   if (order == AC_RECONNECT_SET) {
-    _disconnectEventId = WiFi.onEvent([](WiFiEvent_t e, WiFiEventInfo_t info) {
-      AC_DBG("STA lost connection:%d\n", info.disconnected.reason);
-      AC_DBG("STA connection %s\n", WiFi.reconnect() ? "restored" : "failed");
-    }, WiFiEvent_t::SYSTEM_EVENT_AP_STADISCONNECTED);
-    AC_DBG("Event<%d> handler registered\n", static_cast<int>(WiFiEvent_t::SYSTEM_EVENT_AP_STADISCONNECTED));
+    // Replace the handler left by the previous connection.
+    if (_disconnectEventId != static_cast<WiFiEventId_t>(-1))
+      WiFi.removeEvent(_disconnectEventId);
+    // The handler runs in the event task. It only queues the request,
+    // and handleRequest reconnects. The loss of the station connection
+    // is the signal, the clients leaving the SoftAP are not, nor is the
+    // disconnection that the station made by itself.
+    const uint8_t epoch = _reconnectEpoch;
+    _disconnectEventId = WiFi.onEvent([this, epoch](WiFiEvent_t e, WiFiEventInfo_t info) {
+      AC_UNUSED(e);
+      if (info.disconnected.reason != WIFI_REASON_ASSOC_LEAVE)
+        _postWiFiEvent(AC_WIFIEVENT_RECONNECT, info.disconnected.reason, epoch);
+    }, WiFiEvent_t::SYSTEM_EVENT_STA_DISCONNECTED);
+    AC_DBG("Event<%d> handler registered\n", static_cast<int>(WiFiEvent_t::SYSTEM_EVENT_STA_DISCONNECTED));
   }
   else if (order == AC_RECONNECT_RESET) {
-    if (_disconnectEventId) {
+    if (_disconnectEventId != static_cast<WiFiEventId_t>(-1)) {
       WiFi.removeEvent(_disconnectEventId);
-      AC_DBG("Event<%d> handler released\n", static_cast<int>(WiFiEvent_t::SYSTEM_EVENT_AP_STADISCONNECTED));
+      _disconnectEventId = -1;
+      AC_DBG("Event<%d> handler released\n", static_cast<int>(WiFiEvent_t::SYSTEM_EVENT_STA_DISCONNECTED));
     }
+    // Flush the reconnect requests already queued.
+    _reconnectEpoch++;
   }
 #elif defined(ARDUINO_ARCH_ESP8266)
   bool  strc = order == AC_RECONNECT_SET ? true : false;
@@ -1477,10 +3160,9 @@ void AutoConnect::_waitForEndTransmission(void) {
   AC_DBG("Leaves:");
   unsigned long lt = millis();
 #endif
-  while (_webServer->client().connected()) {
-    delay(1);
-    yield();
-  }
+  _waitForEvent([this]() {
+    return !_webServer->client().connected();
+  }, 0, false);
 #ifdef AC_DEBUG
   // Notifies of the time taken to end the session. If the http client 
   // times out, AC_DEBUG must be enabled and it is necessary to confirm
@@ -1496,17 +3178,18 @@ void AutoConnect::_waitForEndTransmission(void) {
 /**
  *  Disconnects the station from an associated access point.
  *  @param  wifiOff The station mode turning switch.
+ *  @param  timeout Time limit to wait for the disconnection [ms], 0
+ *  means no limit.
  */
-void AutoConnect::_disconnectWiFi(bool wifiOff) {
+void AutoConnect::_disconnectWiFi(bool wifiOff, const unsigned long timeout) {
 #if defined(ARDUINO_ARCH_ESP8266)
   WiFi.disconnect(wifiOff);
 #elif defined(ARDUINO_ARCH_ESP32)
   WiFi.disconnect(wifiOff, true);
 #endif
-  while (WiFi.status() == WL_CONNECTED) {
-    delay(1);
-    yield();
-  }
+  _waitForEvent([]() {
+    return WiFi.status() != WL_CONNECTED;
+  }, timeout, false);
 }
 
 /**
@@ -24,6 +24,7 @@ using WebServerClass = ESP8266WebServer;
 #elif defined(ARDUINO_ARCH_ESP32)
 #include <WiFi.h>
 #include <WebServer.h>
+#include <freertos/event_groups.h>
 using WebServerClass = WebServer;
 #endif
 #include <EEPROM.h>
@@ -31,6 +32,15 @@ using WebServerClass = WebServer;
 #include "AutoConnectDefs.h"
 #include "AutoConnectPage.h"
 #include "AutoConnectCredential.h"
+#include "AutoConnectStats.h"
+#include "AutoConnectEventQueue.h"
+#include "AutoConnectDNS.h"
+#include "AutoConnectMetrics.h"
+#include "AutoConnectHeapTrace.h"
+#include "AutoConnectArena.h"
+#include "AutoConnectTrace.h"
+#include "AutoConnectEvents.h"
+#include "AutoConnectChunk.h"
 #include "AutoConnectTicker.h"
 #include "AutoConnectAux.h"
 #include "AutoConnectTypes.h"
@@ -71,10 +81,22 @@ class AutoConnectConfig {
     immediateStart(false),
     retainPortal(false),
     preserveAPMode(false),
+    fastReconnect(false),
+    failover(false),
+    partialScan(false),
+    portalTask(false),
     beginTimeout(AUTOCONNECT_TIMEOUT),
     portalTimeout(AUTOCONNECT_CAPTIVEPORTAL_TIMEOUT),
+    asyncBudget(AUTOCONNECT_ASYNC_BUDGET),
     menuItems(AC_MENUITEM_CONFIGNEW | AC_MENUITEM_OPENSSIDS | AC_MENUITEM_DISCONNECT | AC_MENUITEM_RESET | AC_MENUITEM_UPDATE | AC_MENUITEM_HOME),
     reconnectInterval(0),
+    reconnectBackoff(0),
+    reconnectCeiling(AUTOCONNECT_RECONNECT_CEILING),
+    roamThreshold(0),
+    roamHysteresis(AUTOCONNECT_ROAM_HYSTERESIS),
+    roamInterval(AUTOCONNECT_ROAM_INTERVAL),
+    heapWatermark(AUTOCONNECT_HEAP_WATERMARK),
+    blockWatermark(AUTOCONNECT_BLOCK_WATERMARK),
     ticker(false),
     tickerPort(AUTOCONNECT_TICKER_PORT),
     tickerOn(LOW),
@@ -114,10 +136,22 @@ class AutoConnectConfig {
     immediateStart(false),
     retainPortal(false),
     preserveAPMode(false),
+    fastReconnect(false),
+    failover(false),
+    partialScan(false),
+    portalTask(false),
     beginTimeout(AUTOCONNECT_TIMEOUT),
     portalTimeout(portalTimeout),
+    asyncBudget(AUTOCONNECT_ASYNC_BUDGET),
     menuItems(AC_MENUITEM_CONFIGNEW | AC_MENUITEM_OPENSSIDS | AC_MENUITEM_DISCONNECT | AC_MENUITEM_RESET | AC_MENUITEM_UPDATE | AC_MENUITEM_HOME),
     reconnectInterval(0),
+    reconnectBackoff(0),
+    reconnectCeiling(AUTOCONNECT_RECONNECT_CEILING),
+    roamThreshold(0),
+    roamHysteresis(AUTOCONNECT_ROAM_HYSTERESIS),
+    roamInterval(AUTOCONNECT_ROAM_INTERVAL),
+    heapWatermark(AUTOCONNECT_HEAP_WATERMARK),
+    blockWatermark(AUTOCONNECT_BLOCK_WATERMARK),
     ticker(false),
     tickerPort(AUTOCONNECT_TICKER_PORT),
     tickerOn(LOW),
@@ -157,10 +191,22 @@ class AutoConnectConfig {
     immediateStart = o.immediateStart;
     retainPortal = o.retainPortal;
     preserveAPMode = o.preserveAPMode;
+    fastReconnect = o.fastReconnect;
+    failover = o.failover;
+    partialScan = o.partialScan;
+    portalTask = o.portalTask;
     beginTimeout = o.beginTimeout;
     portalTimeout = o.portalTimeout;
+    asyncBudget = o.asyncBudget;
     menuItems = o.menuItems;
     reconnectInterval = o.reconnectInterval;
+    reconnectBackoff = o.reconnectBackoff;
+    reconnectCeiling = o.reconnectCeiling;
+    roamThreshold = o.roamThreshold;
+    roamHysteresis = o.roamHysteresis;
+    roamInterval = o.roamInterval;
+    heapWatermark = o.heapWatermark;
+    blockWatermark = o.blockWatermark;
     ticker = o.ticker;
     tickerPort = o.tickerPort;
     tickerOn = o.tickerOn;
@@ -200,10 +246,22 @@ class AutoConnectConfig {
   bool      immediateStart;     /**< Skips WiFi.begin(), start portal immediately */
   bool      retainPortal;       /**< Even if the captive portal times out, it maintains the portal state. */
   bool      preserveAPMode;     /**< Keep existing AP WiFi mode if captive portal won't be started. */
+  bool      fastReconnect;      /**< Reconnect with the lease cached in the RTC memory */
+  bool      failover;           /**< Attempt the ranked candidates in order */
+  bool      partialScan;        /**< Scan the learned channels prior to all channels */
+  bool      portalTask;         /**< Run the portal on the dedicated task, only for ESP32 */
   unsigned long beginTimeout;   /**< Timeout value for WiFi.begin */
   unsigned long portalTimeout;  /**< Timeout value for stay in the captive portal */
+  uint16_t  asyncBudget;        /**< Time limit of one step of beginAsync */
   uint16_t  menuItems;          /**< A compound value of the menu items to be attached */
   uint8_t   reconnectInterval;  /**< Auto-reconnect attempt interval uint */
+  uint8_t   reconnectBackoff;   /**< Growth factor of the reconnection interval */
+  uint16_t  reconnectCeiling;   /**< Upper limit of the reconnection interval uint */
+  int16_t   roamThreshold;      /**< RSSI that starts seeking a better BSSID, 0 disables roaming */
+  uint8_t   roamHysteresis;     /**< Improvement of RSSI required for roaming */
+  uint16_t  roamInterval;       /**< Minimum interval of the scan for roaming [s] */
+  uint32_t  heapWatermark;      /**< Free heap that enters the low memory mode, 0 disables */
+  uint32_t  blockWatermark;     /**< Largest free block that enters the low memory mode, 0 disables */
   bool      ticker;             /**< Drives LED flicker according to WiFi connection status. */
   uint8_t   tickerPort;         /**< GPIO for flicker */
   uint8_t   tickerOn;           /**< A signal for flicker turn on */
@@ -231,6 +289,9 @@ class AutoConnect {
   virtual ~AutoConnect();
   bool  begin(void);
   bool  begin(const char* ssid, const char* passphrase = nullptr, unsigned long timeout = 0);
+  bool  beginAsync(const char* ssid = nullptr, const char* passphrase = nullptr, unsigned long timeout = 0);
+  AC_BEGINSTATE_t beginState(void) const { return _beginState; }
+  const AC_BOOTPROFILE_t& bootProfile(void) const { return _bootProfile; }
   bool  config(AutoConnectConfig& Config);
   bool  config(const char* ap, const char* password = nullptr);
   void  end(void);
@@ -239,6 +300,8 @@ class AutoConnect {
   void  handleRequest(void);
   void  home(const String& uri);
   WebServerClass& host(void);
+  void  lock(void);
+  void  unlock(void);
   String where(void) const { return _auxUri; }
 
   AutoConnectAux* aux(const String& uri) const;
@@ -262,6 +325,8 @@ class AutoConnect {
   typedef std::function<bool(IPAddress&)>  DetectExit_ft;
   typedef std::function<void(IPAddress&)>  ConnectExit_ft;
   typedef std::function<bool(void)>        WhileCaptivePortalExit_ft;
+  typedef std::function<void(AC_BEGINSTATE_t)> BeginStateExit_ft;
+  void  onBeginState(BeginStateExit_ft fn);
   void  onDetect(DetectExit_ft fn);
   void  onConnect(ConnectExit_ft fn);
   void  onNotFound(WebServerClass::THandlerFunction fn);
@@ -277,14 +342,43 @@ class AutoConnect {
     AC_SEEKMODE_NEWONE,
     AC_SEEKMODE_CURRENT
   } AC_SEEKMODE_t;
+  typedef enum {
+    AC_PENDING_WIFI = 0x01,     /**< WiFi event occurred */
+    AC_PENDING_REQUEST = 0x02,  /**< Portal request arrived */
+    AC_PENDING_BUSY = 0x04      /**< A process is in progress */
+  } AC_PENDING_t;
+  typedef enum {
+    AC_WIFIEVENT_GOTIP,         /**< STA got IP */
+    AC_WIFIEVENT_DISCONNECTED,  /**< STA disconnected */
+    AC_WIFIEVENT_RECONNECT      /**< STA reconnection is required */
+  } AC_WIFIEVENT_t;
+  typedef struct {
+    uint8_t   event;            /**< AC_WIFIEVENT_t */
+    uint8_t   reason;           /**< Reason of the disconnection */
+    uint8_t   epoch;            /**< Registration epoch of the reconnect handler */
+    uint8_t   reserved;
+    uint32_t  time;             /**< millis at the occurrence */
+  } AC_WIFIEVENTREC_t;
+  typedef enum {
+    AC_ROAMPHASE_IDLE,
+    AC_ROAMPHASE_SCAN,
+    AC_ROAMPHASE_CONNECT
+  } AC_ROAMPHASE_t;
   void  _authentication(bool allow);
   void  _authentication(bool allow, const HTTPAuthMethod method);
   bool  _configAP(void);
   bool  _configSTA(const IPAddress& ip, const IPAddress& gateway, const IPAddress& netmask, const IPAddress& dns1, const IPAddress& dns2);
   String _getBootUri(void);
   bool  _getConfigSTA(station_config_t* config);
+  bool  _prepareSTA(void);
+  bool  _beginFastReconnect(void);
   bool  _loadAvailCredential(const char* ssid, const AC_PRINCIPLE_t principle = AC_PRINCIPLE_RECENT, const bool excludeCurrent = false);
   bool  _loadCurrentCredential(char* ssid, char* password, const AC_PRINCIPLE_t principle, const bool excludeCurrent);
+  bool  _loadNextCredential(char* ssid, char* password);
+  void  _planScan(void);
+  int8_t  _scanNext(const bool async);
+  unsigned long _reconnectDelay(void);
+  void  _handleRoaming(void);
   bool  _seekCredential(const AC_PRINCIPLE_t principle, const AC_SEEKMODE_t mode);
   void  _startWebServer(void);
   void  _startDNSServer(void);
@@ -293,8 +387,48 @@ class AutoConnect {
   bool  _classifyHandle(HTTPMethod mothod, String uri);
   void  _handleUpload(const String& requestUri, const HTTPUpload& upload);
   void  _handleNotFound(void);
+  void  _handleProbe(void);
+#ifdef AUTOCONNECT_USE_METRICS
+  void  _handleMetrics(void);
+  void  _markRequest(const AC_METRICSROUTE_t route, const uint32_t bytes = 0);
+  void  _recordRequest(void);
+#endif // !AUTOCONNECT_USE_METRICS
+#ifdef AUTOCONNECT_USE_TRACE
+  void  _handleTrace(void);
+#endif // !AUTOCONNECT_USE_TRACE
+#ifdef AUTOCONNECT_USE_STREAMCONFIG
+  void  _handleConfig(void);
+  void  _streamToken(AutoConnectChunk<WebServerClass>& out, const char* token, PageArgument& args);
+#endif // !AUTOCONNECT_USE_STREAMCONFIG
+#ifdef AUTOCONNECT_USE_JSONAPI
+  void  _insertApi(void);
+  void  _handleApiStatus(void);
+  void  _handleApiScan(void);
+  void  _handleApiCredentials(void);
+  void  _handleApiConnect(void);
+  void  _handleApiDelete(void);
+  void  _handleApiReset(void);
+  void  _beginJson(void);
+  static void  _printJson(Print& out, const char* str, const size_t len);
+#endif // !AUTOCONNECT_USE_JSONAPI
+#ifdef AUTOCONNECT_USE_SPA
+  void  _handleApp(void);
+#endif // !AUTOCONNECT_USE_SPA
+#ifdef AUTOCONNECT_USE_EVENTS
+  void  _handleEvents(void);
+  void  _handleSubscribe(void);
+  void  _pushStatus(void);
+#endif // !AUTOCONNECT_USE_EVENTS
+#ifdef AUTOCONNECT_USE_ARENA
+  void  _releaseArena(void);
+#endif // !AUTOCONNECT_USE_ARENA
+  bool  _authenticateRequest(void);
   void  _purgePages(void);
   virtual PageElement*  _setupPage(String& uri);
+  bool  _allowAuthentication(bool allow);
+  bool  _evalMemory(void);
+  bool  _isLowPriority(const String& uri) const;
+  void  _rejectRequest(void);
 #ifdef AUTOCONNECT_USE_JSON
   template<typename T>
   bool  _parseJson(T in);
@@ -302,37 +436,80 @@ class AutoConnect {
 #endif // !AUTOCONNECT_USE_JSON
 
   /** Request handlers implemented by Page Builder */
+  template<typename T>
+  void    _acceptCredential(T& args);
   String  _induceConnect(PageArgument& args);
   String  _induceDisconnect(PageArgument& args);
   String  _induceReset(PageArgument& args);
   String  _invokeResult(PageArgument& args);
 
+  /** For beginAsync */
+  bool  _advanceBegin(void);
+  void  _handleBeginAsync(void);
+  bool  _isBeginInProgress(void) const { return _beginState > AC_BEGINSTATE_IDLE && _beginState < AC_BEGINSTATE_CONNECTED; }
+  bool  _isConnectInProgress(void) const { return _rfConnect || _rfWaiting || _beginState == AC_BEGINSTATE_PORTALCONNECT; }
+  void  _setBeginState(const AC_BEGINSTATE_t state);
+  void  _beginProfile(const bool async);
+  void  _enterPhase(const AC_BOOTPHASE_t phase);
+  void  _endProfile(const bool portal);
+  void  _beginStation(void);
+  void  _beginFallback(void);
+  bool  _beginNextCandidate(void);
+  void  _startPortal(void);
+
   /** For portal control */
+  bool  _advanceSoftAP(void);
   bool  _captivePortal(void);
+  void  _handleConnectResult(void);
   bool  _hasTimeout(unsigned long timeout);
   bool  _isIP(String ipStr);
   void  _softAP(void);
+  void  _settleConnect(const wl_status_t wifiStatus, const unsigned long elapsed);
   wl_status_t _waitForConnect(unsigned long timeout);
+  void  _attachWaitEvents(void);
+  void  _detachWaitEvents(void);
+  void  _serveClient(void);
+  bool  _waitForEvent(std::function<bool(void)> condition, const unsigned long timeout, const bool serve = true);
+  void  _wakeWaiter(void);
+  void  _postWiFiEvent(const AC_WIFIEVENT_t event, const uint8_t reason = 0, const uint8_t epoch = 0);
+  void  _handleWiFiEvents(void);
   void  _waitForEndTransmission(void);
-  void  _disconnectWiFi(bool wifiOff);
+  void  _disconnectWiFi(bool wifiOff, const unsigned long timeout = 0);
   void  _setReconnect(const AC_STARECONNECT_t order);
 
+  /** For the dedicated portal task */
+  void  _startTask(void);
+  void  _stopTask(void);
+#ifdef ARDUINO_ARCH_ESP32
+  bool  _isForeignTask(void) const { return _portalTask && xTaskGetCurrentTaskHandle() != _portalTask; }
+  static void _portalTaskEntry(void* arg);
+#else
+  bool  _isForeignTask(void) const { return false; }
+#endif
+
   /** Utilities */
   String               _attachMenuItem(const AC_MENUITEM_t item);
   static uint32_t      _getChipId(void);
   static uint32_t      _getFlashChipRealSize(void);
+  static uint32_t      _getMaxFreeBlock(void);
   static String        _toMACAddressString(const uint8_t mac[]);
   static unsigned int  _toWiFiQuality(int32_t rssi);
   ConnectExit_ft       _onConnectExit;
   DetectExit_ft        _onDetectExit;
   WhileCaptivePortalExit_ft _whileCaptivePortal;
+  BeginStateExit_ft    _onBeginStateExit;
   WebServerClass::THandlerFunction _notFoundHandler;
   size_t               _freeHeapSize;
+  bool                 _lowMemory = false;  /**< The request is served in the low memory mode */
+#ifdef AUTOCONNECT_USE_EVENTS
+  wl_status_t          _eventStatus = WL_NO_SHIELD; /**< WiFi status pushed lastly */
+  bool                 _eventConnecting = false;    /**< Connection attempt pushed lastly */
+#endif // !AUTOCONNECT_USE_EVENTS
 
   /** Servers which works in concert. */
   typedef std::unique_ptr<WebServerClass, std::function<void(WebServerClass *)> > WebserverUP;
   WebserverUP _webServer = WebserverUP(nullptr, std::default_delete<WebServerClass>());
-  std::unique_ptr<DNSServer>      _dnsServer;
+  std::unique_ptr<AutoConnectDNS> _dnsServer;
 
   /**
    *  Dynamically hold one page of AutoConnect menu.
@@ -359,16 +536,76 @@ class AutoConnect {
   uint8_t       _connectCh;
   unsigned long _portalAccessPeriod;
   unsigned long _attemptPeriod;
+  unsigned long _reconnectWait = 0;   /**< Delay until the next reconnection */
+  uint8_t       _reconnectAttempts = 0; /**< Reconnections since disconnected */
+
+  /** beginAsync progress */
+  AC_BEGINSTATE_t _beginState = AC_BEGINSTATE_IDLE;
+  unsigned long _beginTimeout;  /**< Timeout for each connection attempt */
+  unsigned long _stateEntry;    /**< Time entered the current state */
+  bool          _beginExcludeCurrent; /**< The SDK has a station config */
+  uint8_t       _softAPPhase = 0;     /**< Progress of SoftAP activation */
+  uint8_t       _leaseUses;           /**< Fast reconnects with the current lease */
+
+  /** Time profile of begin and beginAsync */
+  AC_BOOTPROFILE_t  _bootProfile = {};
+  AC_BOOTPHASE_t  _bootPhase = AC_BOOTPHASE_PREPARE;  /**< Phase being profiled */
+  bool          _rfProfiling = false; /**< The begin is being profiled */
+  unsigned long _profileStart;        /**< micros() at the beginning */
+  unsigned long _phaseEntry;          /**< micros() at the entry of the current phase */
+
+  /** Candidates ranked by _seekCredential for the failover */
+  uint8_t _candidates[AUTOCONNECT_CANDIDATES];  /**< Credential entries */
+  uint8_t _candidateCount = 0;  /**< Number of the candidates */
+  uint8_t _candidateNext = 0;   /**< Candidate to be attempted next */
+
+  /** Scan plan, channel 0 means the full sweep */
+  uint8_t _scanPlan[AUTOCONNECT_STATS_ENTRIES + 1]; /**< Channels to be scanned */
+  uint8_t _scanPlanCount = 0;   /**< Number of the planned scans */
+  uint8_t _scanPlanNext = 0;    /**< Scan to be started next */
+  uint8_t _partialScans = 0;    /**< Partial plans since the last full sweep */
+
+  /** Roaming monitor */
+  AC_ROAMPHASE_t  _roamPhase = AC_ROAMPHASE_IDLE;
+  int16_t       _roamRSSI = 0;    /**< Smoothed RSSI of the current link */
+  unsigned long _roamSampled = 0; /**< Time of the last RSSI sampling */
+  unsigned long _roamScanned = 0; /**< Time of the last scan for roaming */
+  unsigned long _roamStarted;     /**< Time of the directed connect started */
+  uint16_t      _roamCount = 0;   /**< Number of roaming */
 
   /** The control indicators */
   bool  _rfAdHocBegin = false;  /**< Specified with AutoConnect::begin */
+  bool  _rfFastReconnect = false; /**< Attempting with the cached lease */
   bool  _rfConnect = false;     /**< URI /connect requested */
   bool  _rfDisconnect = false;  /**< URI /disc requested */
   bool  _rfReset = false;       /**< URI /reset requested */
+  bool  _rfWaiting = false;     /**< Waiting for the WiFi event */
+  bool  _rfServing = false;     /**< The web server is handling a request */
+  volatile uint8_t  _pending = AC_PENDING_BUSY; /**< AC_PENDING_t requiring the full pass of handleRequest */
+  unsigned long _idleChecked = 0; /**< Time of the last full pass */
   wl_status_t   _rsConnect;     /**< connection result */
 #ifdef ARDUINO_ARCH_ESP32
   WiFiEventId_t _disconnectEventId = -1; /**< STA disconnection event handler registered id  */
+  uint8_t       _reconnectEpoch = 0;  /**< Invalidates the reconnect requests queued before the reset */
+  WiFiEventId_t _wakeEventId = -1;  /**< Event handler id to wake the waiter */
+  EventGroupHandle_t  _waitEvents = nullptr;  /**< Wakes the waiter of the WiFi event */
+  TaskHandle_t  _portalTask = nullptr;  /**< Dedicated task running the portal */
+  SemaphoreHandle_t _taskLock = nullptr;  /**< Guards AutoConnect between the tasks */
+  volatile bool _rfTaskStop = false;  /**< The portal task is requested to stop */
+#elif defined(ARDUINO_ARCH_ESP8266)
+  WiFiEventHandler  _gotIPHandler;        /**< Wakes the waiter by STA got IP */
+  WiFiEventHandler  _disconnectedHandler; /**< Wakes the waiter by STA disconnected */
 #endif
+  bool  _waitEventsAttached = false;  /**< The event handlers to wake the waiter are registered */
+  /** WiFi events from the callbacks, drained by handleRequest */
+  AutoConnectEventQueue<AC_WIFIEVENTREC_t, AUTOCONNECT_EVENTQUEUE_SIZE>  _wifiEvents;
+#ifdef AUTOCONNECT_USE_METRICS
+  /** Metrics of the portal */
+  AutoConnectMetrics  _metrics;
+  AC_METRICSROUTE_t _requestRoute = AC_METRICSROUTE_NONE; /**< Route of the request in progress */
+  unsigned long _requestStart;  /**< Time the request was accepted */
+  uint32_t      _requestBytes;  /**< Size of the response */
+#endif // !AUTOCONNECT_USE_METRICS
   /** Only available with ticker enabled */
   std::unique_ptr<AutoConnectTicker>  _ticker;
 
@@ -377,6 +614,7 @@ class AutoConnect {
   String        _uri;           /**< Requested URI */
   String        _redirectURI;   /**< Redirect destination */
   String        _menuTitle;     /**< Title string of the page */
+  String        _probeResponse; /**< Precomputed response to the connectivity probes */
 
   /** PageElements of AutoConnect site. */
   static const char _CSS_BASE[] PROGMEM;
@@ -401,11 +639,26 @@ class AutoConnect {
   static const char _PAGE_FAIL[] PROGMEM;
   static const char _PAGE_404[] PROGMEM;
 
+  static const char* const _probeUris[];
   static const struct PageTranserModeST {
     const char*              uri;
     const TransferEncoding_t transMode;
     const size_t             rSize;
   } _pageBuildMode[];
+#ifdef AUTOCONNECT_USE_STREAMCONFIG
+  static const struct StreamTokenST {
+    const char* token;
+    PGM_P       text;
+    String (AutoConnect::*builder)(PageArgument&);
+  } _configTokens[];
+#endif // !AUTOCONNECT_USE_STREAMCONFIG
+#ifdef AUTOCONNECT_USE_JSONAPI
+  static const struct ApiRouteST {
+    const char* uri;
+    HTTPMethod  method;
+    void (AutoConnect::*handler)(void);
+  } _apiRoutes[];
+#endif // !AUTOCONNECT_USE_JSONAPI
 
   /** Token handlers for PageBuilder */
   String _token_CSS_BASE(PageArgument& args);
@@ -434,6 +687,8 @@ class AutoConnect {
   String _token_HEAD(PageArgument& args);
   String _token_HIDDEN_COUNT(PageArgument& args);
   String _token_LIST_SSID(PageArgument& args);
+  void   _listSSID(Print& out, const uint8_t page);
+  void   _scanForList(void);
   String _token_LOCAL_IP(PageArgument& args);
   String _token_NETMASK(PageArgument& args);
   String _token_OPEN_SSID(PageArgument& args);
@@ -0,0 +1,263 @@
+/**
+ *  AutoConnect JSON status and control API implementation.
+ *  The API answers the same interactions as the portal pages with the
+ *  compact JSON, and the single-page front end consumes it.
+ *  @file   AutoConnectAPI.cpp
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#if defined(ARDUINO_ARCH_ESP8266)
+#include <ESP8266WiFi.h>
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <WiFi.h>
+#define ENC_TYPE_NONE WIFI_AUTH_OPEN
+#endif
+#include "AutoConnect.h"
+#include "AutoConnectCredential.h"
+#ifdef AUTOCONNECT_USE_SPA
+#include "AutoConnectSPA.h"
+#endif
+
+#ifdef AUTOCONNECT_USE_JSONAPI
+
+// The routes of the JSON API, the requests which change the state of the
+// module only accept POST.
+const AutoConnect::ApiRouteST AutoConnect::_apiRoutes[] = {
+  { AUTOCONNECT_URI_API "/status",      HTTP_GET,   &AutoConnect::_handleApiStatus },
+  { AUTOCONNECT_URI_API "/scan",        HTTP_GET,   &AutoConnect::_handleApiScan },
+  { AUTOCONNECT_URI_API "/credentials", HTTP_GET,   &AutoConnect::_handleApiCredentials },
+  { AUTOCONNECT_URI_API "/connect",     HTTP_POST,  &AutoConnect::_handleApiConnect },
+  { AUTOCONNECT_URI_API "/delete",      HTTP_POST,  &AutoConnect::_handleApiDelete },
+  { AUTOCONNECT_URI_API "/reset",       HTTP_POST,  &AutoConnect::_handleApiReset }
+};
+
+/**
+ *  Register the routes of the JSON API and the single-page front end
+ *  to the web server.
+ */
+void AutoConnect::_insertApi(void) {
+  for (const ApiRouteST& route : _apiRoutes)
+    _webServer->on(route.uri, route.method, std::bind(route.handler, this));
+#ifdef AUTOCONNECT_USE_SPA
+  _webServer->on(AUTOCONNECT_URI_APP, HTTP_GET, std::bind(&AutoConnect::_handleApp, this));
+#endif
+}
+
+/**
+ *  Respond the status of the station and the SoftAP, which corresponds
+ *  to the statistics page of /_ac.
+ */
+void AutoConnect::_handleApiStatus(void) {
+  if (!_authenticateRequest())
+    return;
+  _beginJson();
+  {
+    AutoConnectChunk<WebServerClass>  out(*_webServer);
+    out.print(F("{\"status\":"));
+    out.print(static_cast<int>(WiFi.status()));
+    out.print(F(",\"result\":"));
+    out.print(static_cast<int>(_rsConnect));
+    out.print(F(",\"connecting\":"));
+    out.print(_isConnectInProgress() ? F("true") : F("false"));
+    out.print(F(",\"mode\":"));
+    out.print(static_cast<int>(WiFi.getMode()));
+    out.print(F(",\"ssid\":"));
+    String  ssid = WiFi.SSID();
+    _printJson(out, ssid.c_str(), ssid.length());
+    out.print(F(",\"bssid\":\""));
+    out.print(WiFi.BSSIDstr());
+    out.print(F("\",\"rssi\":"));
+    out.print(WiFi.RSSI());
+    out.print(F(",\"channel\":"));
+    out.print(WiFi.channel());
+    out.print(F(",\"ip\":\""));
+    out.print(WiFi.localIP().toString());
+    out.print(F("\",\"gateway\":\""));
+    out.print(WiFi.gatewayIP().toString());
+    out.print(F("\",\"netmask\":\""));
+    out.print(WiFi.subnetMask().toString());
+    out.print(F("\",\"softap\":\""));
+    out.print(WiFi.softAPIP().toString());
+    out.print(F("\",\"mac\":\""));
+    out.print(WiFi.macAddress());
+    out.print(F("\",\"heap\":"));
+    out.print(ESP.getFreeHeap());
+    out.print(F(",\"uptime\":"));
+    out.print(millis() / 1000);
+    out.print('}');
+  }
+  _webServer->sendContent(_emptyString);
+}
+
+/**
+ *  Scan the networks and respond the found access points. The hidden
+ *  networks are only counted as the configuration page does.
+ */
+void AutoConnect::_handleApiScan(void) {
+  if (!_authenticateRequest())
+    return;
+  _scanForList();
+  _beginJson();
+  {
+    AutoConnectChunk<WebServerClass>  out(*_webServer);
+    bool  first = true;
+    _hiddenSSIDCount = 0;
+    out.print(F("{\"networks\":["));
+    for (int16_t i = 0; i < _scanCount; i++) {
+      String  ssid = WiFi.SSID(i);
+      if (!ssid.length()) {
+        _hiddenSSIDCount++;
+        continue;
+      }
+      out.print(first ? F("{\"ssid\":") : F(",{\"ssid\":"));
+      first = false;
+      _printJson(out, ssid.c_str(), ssid.length());
+      out.print(F(",\"bssid\":\""));
+      out.print(WiFi.BSSIDstr(i));
+      out.print(F("\",\"quality\":"));
+      out.print(AutoConnect::_toWiFiQuality(WiFi.RSSI(i)));
+      out.print(F(",\"channel\":"));
+      out.print(WiFi.channel(i));
+      out.print(F(",\"secure\":"));
+      out.print(WiFi.encryptionType(i) != ENC_TYPE_NONE ? F("true}") : F("false}"));
+    }
+    out.print(F("],\"hidden\":"));
+    out.print(_hiddenSSIDCount);
+    out.print('}');
+  }
+  _webServer->sendContent(_emptyString);
+}
+
+/**
+ *  Respond the saved credentials. The passphrases are not exposed.
+ */
+void AutoConnect::_handleApiCredentials(void) {
+  if (!_authenticateRequest())
+    return;
+  _beginJson();
+  {
+    AutoConnectChunk<WebServerClass>  out(*_webServer);
+    AutoConnectCredential credential(_apConfig.boundaryOffset);
+    station_config_t  entry;
+    bool  first = true;
+    uint8_t entries = credential.entries();
+    out.print(F("{\"credentials\":["));
+    for (uint8_t i = 0; i < entries; i++) {
+      if (!credential.load(static_cast<int8_t>(i), &entry))
+        continue;
+      out.print(first ? F("{\"ssid\":") : F(",{\"ssid\":"));
+      first = false;
+      _printJson(out, reinterpret_cast<const char*>(entry.ssid), sizeof(entry.ssid));
+      out.print(F(",\"bssid\":\""));
+      out.print(AutoConnect::_toMACAddressString(entry.bssid));
+      out.print(F("\",\"dhcp\":"));
+      if (entry.dhcp == STA_DHCP)
+        out.print(F("true}"));
+      else {
+        out.print(F("false,\"ip\":\""));
+        out.print(IPAddress(entry.config.sta.ip).toString());
+        out.print(F("\"}"));
+      }
+    }
+    out.print(F("]}"));
+  }
+  _webServer->sendContent(_emptyString);
+}
+
+/**
+ *  Accept the connection request with the same arguments as the form of
+ *  the configuration page, SSID and Passphrase or Credential to connect
+ *  with the saved credential. The connection is attempted after the
+ *  response, and the client polls its result with the status.
+ */
+void AutoConnect::_handleApiConnect(void) {
+  if (!_authenticateRequest())
+    return;
+  if (!_webServer->hasArg(String(F(AUTOCONNECT_PARAMID_SSID))) && !_webServer->hasArg(String(F(AUTOCONNECT_PARAMID_CRED)))) {
+    _webServer->send(400, String(F("application/json")), String(F("{\"accepted\":false}")));
+    return;
+  }
+  // The connection attempt in progress keeps its credential.
+  if (_isConnectInProgress()) {
+    _webServer->send(409, String(F("application/json")), String(F("{\"accepted\":false}")));
+    return;
+  }
+  _acceptCredential(*_webServer);
+  _candidateCount = _candidateNext = 0;
+  _rfConnect = true;
+  _webServer->send(202, String(F("application/json")), String(F("{\"accepted\":true}")));
+}
+
+/**
+ *  Delete the saved credential specified by the SSID argument.
+ */
+void AutoConnect::_handleApiDelete(void) {
+  if (!_authenticateRequest())
+    return;
+  AutoConnectCredential credential(_apConfig.boundaryOffset);
+  bool  rc = credential.del(_webServer->arg(String(F(AUTOCONNECT_PARAMID_SSID))).c_str());
+  _webServer->send(rc ? 200 : 404, String(F("application/json")), rc ? String(F("{\"deleted\":true}")) : String(F("{\"deleted\":false}")));
+}
+
+/**
+ *  Accept the reset request, the module resets after the response.
+ */
+void AutoConnect::_handleApiReset(void) {
+  if (!_authenticateRequest())
+    return;
+  _rfReset = true;
+  _webServer->send(202, String(F("application/json")), String(F("{\"accepted\":true}")));
+}
+
+/**
+ *  Start the chunked response of JSON, which is not cached.
+ */
+void AutoConnect::_beginJson(void) {
+  _webServer->sendHeader(String(F("Cache-Control")), String(F("no-cache, no-store, must-revalidate")), true);
+  _webServer->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  _webServer->send(200, String(F("application/json")), _emptyString);
+}
+
+/**
+ *  Output the string as JSON string with the escape. The string is
+ *  terminated by the null or the length, as the SSID of the credential
+ *  is not null-terminated with 32 characters.
+ *  @param  out   Output destination.
+ *  @param  str   String to be output.
+ *  @param  len   Maximum length of the string.
+ */
+void AutoConnect::_printJson(Print& out, const char* str, const size_t len) {
+  out.print('"');
+  for (size_t i = 0; i < len && str[i]; i++) {
+    const char  c = str[i];
+    if (c == '"' || c == '\\') {
+      out.print('\\');
+      out.print(c);
+    }
+    else if (static_cast<uint8_t>(c) < 0x20) {
+      char  esc[7];
+      snprintf_P(esc, sizeof(esc), PSTR("\\u%04x"), static_cast<unsigned int>(c));
+      out.print(esc);
+    }
+    else
+      out.print(c);
+  }
+  out.print('"');
+}
+#endif // !AUTOCONNECT_USE_JSONAPI
+
+#ifdef AUTOCONNECT_USE_SPA
+/**
+ *  Respond the single-page front end. It is precompressed with gzip
+ *  and sent from the flash as it is.
+ */
+void AutoConnect::_handleApp(void) {
+  if (!_authenticateRequest())
+    return;
+  _webServer->sendHeader(String(F("Content-Encoding")), String(F("gzip")));
+  _webServer->send_P(200, PSTR("text/html"), reinterpret_cast<PGM_P>(_autoconnectSPA), sizeof(_autoconnectSPA));
+}
+#endif // !AUTOCONNECT_USE_SPA
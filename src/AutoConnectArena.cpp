@@ -0,0 +1,67 @@
+/**
+ *  AutoConnectArena class implementation.
+ *  @file   AutoConnectArena.cpp
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#include "AutoConnectDefs.h"
+
+#ifdef AUTOCONNECT_USE_ARENA
+
+#include "AutoConnectArena.h"
+
+uint32_t  AutoConnectArena::_pool[(AUTOCONNECT_ARENA_SIZE + 3) / 4];
+size_t    AutoConnectArena::_used = 0;
+size_t    AutoConnectArena::_peak = 0;
+uint32_t  AutoConnectArena::_overflow = 0;
+void*     AutoConnectArena::_owner = nullptr;
+volatile bool AutoConnectArena::_open = false;
+
+/**
+ *  Identify the running task. ESP8266 has only the loop task.
+ *  @return The handle of the running task.
+ */
+static inline void* _arenaTask(void) {
+#if defined(ARDUINO_ARCH_ESP32)
+  return static_cast<void*>(xTaskGetCurrentTaskHandle());
+#else
+  return nullptr;
+#endif
+}
+
+/**
+ *  Open the arena for the request that the running task serves.
+ */
+void AutoConnectArena::open(void) {
+  reset();
+  _owner = _arenaTask();
+  _open = true;
+}
+
+/**
+ *  Carve a buffer from the pool. The size is rounded up to keep the
+ *  next buffer aligned.
+ *  @param  size  Size of the buffer.
+ *  @return Pointer to the buffer, nullptr if the pool is exhausted, the
+ *  size is 0, or the running task is not serving the request.
+ */
+void* AutoConnectArena::alloc(const size_t size) {
+  if (!size || !_open || _owner != _arenaTask())
+    return nullptr;
+  size_t  aligned = (size + 3) & ~static_cast<size_t>(3);
+  if (aligned > sizeof(_pool) - _used) {
+    _overflow++;
+    AC_DBG("Arena exhausted %u/%u\n", static_cast<unsigned int>(size), static_cast<unsigned int>(sizeof(_pool) - _used));
+    return nullptr;
+  }
+  void* p = reinterpret_cast<uint8_t*>(_pool) + _used;
+  _used += aligned;
+  if (_used > _peak)
+    _peak = _used;
+  return p;
+}
+
+#endif // !AUTOCONNECT_USE_ARENA
@@ -0,0 +1,91 @@
+/**
+ *  Declaration of AutoConnectArena and AutoConnectScratch class.
+ *  A bump allocator from the static pool for the temporary buffers of
+ *  the page rendering, which is released all at once after the web
+ *  server has responded.
+ *  @file   AutoConnectArena.h
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTARENA_H_
+#define _AUTOCONNECTARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <Arduino.h>
+#include "AutoConnectDefs.h"
+
+#ifdef AUTOCONNECT_USE_ARENA
+// Uses the arena only with AUTOCONNECT_USE_ARENA.
+#define AC_ARENA(s) do {s;} while (0)
+#else
+#define AC_ARENA(s) do {(void)0;} while (0)
+#endif // !AUTOCONNECT_USE_ARENA
+
+#ifdef AUTOCONNECT_USE_ARENA
+
+/**
+ * The buffers are carved from the pool in order and never released
+ * individually. AutoConnect opens the arena when the web server starts
+ * handling a request and resets it when the request has been served, so
+ * a buffer must not outlive the request in which it was taken. The
+ * arena belongs to the task serving the request: the allocation from
+ * the other task, such as the Sketch calling toHTML while the ESP32
+ * portal task serves, and the allocation outside the request are given
+ * nullptr and fall back to the heap. The request that exhausts the pool
+ * is counted as an overflow.
+ */
+class AutoConnectArena {
+ public:
+  static void*    alloc(const size_t size);
+  static void     open(void);
+  static void     close(void) { _open = false; reset(); }
+  static void     reset(void) { _used = 0; _peak = 0; }
+  static size_t   used(void) { return _used; }
+  static size_t   peak(void) { return _peak; }
+  static uint32_t overflow(void) { return _overflow; }
+
+ protected:
+  static uint32_t _pool[(AUTOCONNECT_ARENA_SIZE + 3) / 4];  /**< Pool, 4-byte aligned */
+  static size_t   _used;      /**< Bytes carved in the current request */
+  static size_t   _peak;      /**< Largest _used of the current request */
+  static uint32_t _overflow;  /**< Allocations that did not fit */
+  static void*    _owner;     /**< Task serving the request */
+  static volatile bool  _open;  /**< A request is being served */
+};
+
+#endif // !AUTOCONNECT_USE_ARENA
+
+/**
+ * A temporary buffer for the rendering, valid within its scope. It is
+ * taken from the arena if available, otherwise from the heap.
+ */
+class AutoConnectScratch {
+ public:
+  explicit AutoConnectScratch(const size_t size) : _buf(nullptr), _heap(false) {
+#ifdef AUTOCONNECT_USE_ARENA
+    _buf = static_cast<char*>(AutoConnectArena::alloc(size));
+#endif
+    if (!_buf) {
+      _buf = static_cast<char*>(malloc(size));
+      _heap = true;
+    }
+  }
+  ~AutoConnectScratch() {
+    if (_heap)
+      free(_buf);
+  }
+  AutoConnectScratch(const AutoConnectScratch&) = delete;
+  AutoConnectScratch& operator=(const AutoConnectScratch&) = delete;
+  char* get(void) const { return _buf; }
+
+ private:
+  char* _buf;   /**< Buffer, nullptr if not allocated */
+  bool  _heap;  /**< _buf was taken from the heap */
+};
+
+#endif // !_AUTOCONNECTARENA_H_
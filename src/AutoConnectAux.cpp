@@ -367,6 +367,7 @@ void AutoConnectAux::_join(AutoConnect& ac) {
  * AutoConnect.
  */
 const String AutoConnectAux::_injectMenu(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnectAux::_injectMenu");
   String  menuItem;
 
   if (_menu)
@@ -380,6 +381,7 @@ const String AutoConnectAux::_injectMenu(PageArgument& args) {
  * Insert the uri that caused the request to the aux.
  */
 const String AutoConnectAux::_indicateUri(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnectAux::_indicateUri");
   AC_UNUSED(args);
   String  lastUri = _uriStr;
   // The following code contains adding and trimming a blank that is
@@ -403,6 +405,7 @@ const String AutoConnectAux::_indicateUri(PageArgument& args) {
  * @return HTML string that should be inserted.
  */
 const String AutoConnectAux::_indicateEncType(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnectAux::_indicateEncType");
   AC_UNUSED(args);
   String  encType = String("");
   for (AutoConnectElement& elm : _addonElm)
@@ -419,6 +422,7 @@ const String AutoConnectAux::_indicateEncType(PageArgument& args) {
  * @return HTML string that should be inserted.
  */
 const String AutoConnectAux::_insertElement(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnectAux::_insertElement");
   String  body = String("");
 
   // When WebServerClass::handleClient calls RequestHandler, the parsed
@@ -462,6 +466,7 @@ const String AutoConnectAux::_insertElement(PageArgument& args) {
  * @return HTML string that should be inserted.
  */
 const String AutoConnectAux::_insertStyle(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnectAux::_insertStyle");
   String  css = String("");
 
   for (AutoConnectElement& elm : _addonElm) {
@@ -481,6 +486,7 @@ const String AutoConnectAux::_insertStyle(PageArgument& args) {
  * @return A PageElement of auxiliary page.
  */
 PageElement* AutoConnectAux::_setupPage(const String& uri) {
+  AC_HEAPTRACE_SCOPE("AutoConnectAux::_setupPage");
   PageElement*  elm = nullptr;
 
   if (_ac) {
@@ -512,7 +518,7 @@ PageElement* AutoConnectAux::_setupPage(const String& uri) {
       elm->addToken(String(FPSTR("ENC_TYPE")), std::bind(&AutoConnectAux::_indicateEncType, this, std::placeholders::_1));
       elm->addToken(String(FPSTR("AUX_ELEMENT")), std::bind(&AutoConnectAux::_insertElement, this, std::placeholders::_1));
       // Restore transfer mode by each page
-      mother->_responsePage->chunked(chunk);
+      mother->_responsePage->chunked(mother->_lowMemory ? PB_Chunk : chunk);
 
       // Register authentication
       // Determine the necessity of authentication from the conditions of
@@ -889,9 +895,43 @@ AutoConnectElement& AutoConnectAux::_loadElement(JsonObject& element, const Stri
 }
 
 /**
- * Serialize an element specified the name into the stream.
+ * Serialize the elements specified by the names into the file. The rate
+ * limit of the element persistence is checked before the file is opened,
+ * so a refused save leaves the file intact. The written bytes are
+ * accounted to the region.
+ * @param  fs    The file system that holds the file.
+ * @param  path  Path of the file to be overwritten.
+ * @param  names Names of the elements to be output.
+ * @param  region The flash region of the file system, AC_WEARREGION_NONE
+ *         for SD.
+ * @return Number of bytes output, 0 if the rate limit refused it or the
+ *         file could not be opened.
+ */
+size_t AutoConnectAux::saveElement(fs::FS& fs, const char* path, std::vector<String> const& names, const AC_WEARREGION_t region) {
+  if (!AutoConnectWear::admit(AC_WEARSUBSYS_ELEMENT))
+    return 0;
+
+  fs::File  out = fs.open(path, "w");
+  if (!out) {
+    AC_DBG("%s open failed\n", path);
+    return 0;
+  }
+  size_t  size_n = saveElement(out, names);
+  out.close();
+  if (size_n) {
+    AutoConnectWear::write(AC_WEARSUBSYS_ELEMENT, region, size_n);
+    AutoConnectWear::commit(AC_WEARSUBSYS_ELEMENT, region);
+  }
+  return size_n;
+}
+
+/**
+ * Serialize an element specified the name into the stream. The stream is
+ * already opened by the caller and its destination is unknown, so the
+ * rate limit and the wear accounting of the element persistence do not
+ * apply to it.
  * @param  name  An element name to be output.
- * @return Number of bytes output
+ * @return Number of bytes output.
  */
 size_t AutoConnectAux::saveElement(Stream& out, std::vector<String> const& names) {
   size_t  bufferSize = 0;
@@ -17,9 +17,11 @@
 #include <type_traits>
 #ifdef AUTOCONNECT_USE_JSON
 #include <Stream.h>
+#include <FS.h>
 #endif // !AUTOCONNECT_USE_JSON
 #include <PageBuilder.h>
 #include "AutoConnectElement.h"
+#include "AutoConnectStats.h"
 #include "AutoConnectTypes.h"
 
 class AutoConnect;  // Reference to avoid circular
@@ -89,6 +91,7 @@ class AutoConnectAux : public PageBuilder {
   bool  loadElement(Stream& in, const String& name = String(""));       /**< Load specified element */
   bool  loadElement(Stream& in, std::vector<String> const& names);      /**< Load any specified elements */
   size_t  saveElement(Stream& out, std::vector<String> const& names = {});  /**< Write elements of AutoConnectAux to the stream */
+  size_t  saveElement(fs::FS& fs, const char* path, std::vector<String> const& names = {}, const AC_WEARREGION_t region = AC_WEARREGION_FS);  /**< Write elements of AutoConnectAux to the file */
 #endif // !AUTOCONNECT_USE_JSON
 
   TransferEncoding_t    chunk;                                          /**< Chunked transfer specified */
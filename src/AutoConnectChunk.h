@@ -0,0 +1,93 @@
+/**
+ *  Declaration of AutoConnectChunk class.
+ *  A fixed-size window that accumulates the content of the page being
+ *  streamed and sends it as a chunk of the chunked transfer whenever it
+ *  fills up.
+ *  @file   AutoConnectChunk.h
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTCHUNK_H_
+#define _AUTOCONNECTCHUNK_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <Arduino.h>
+#include "AutoConnectDefs.h"
+#include "AutoConnectArena.h"
+
+/**
+ * The window is allocated once with the fixed size, so the memory for
+ * streaming a page does not depend on the length of the content. It is
+ * a scratch buffer, taken from the arena with AUTOCONNECT_USE_ARENA. If
+ * the window cannot be allocated, the small window embedded in the
+ * object, that is on the stack, is used instead so that the content is
+ * not sent byte by byte under the memory pressure.
+ * @param  T   Type of the web server, ESP8266WebServer or WebServer.
+ */
+template<typename T>
+class AutoConnectChunk : public Print {
+ public:
+  explicit AutoConnectChunk(T& server, const size_t size = AUTOCONNECT_CHUNKWINDOW_SIZE) : _server(server), _size(size), _len(0), _window(size), _buf(_window.get()) {
+    if (!_buf) {
+      _buf = _fallback;
+      _size = sizeof(_fallback);
+    }
+  }
+  ~AutoConnectChunk() {
+    flush();
+  }
+
+  using Print::write;
+
+  size_t  write(uint8_t c) override {
+    return write(&c, 1);
+  }
+
+  size_t  write(const uint8_t* buffer, size_t size) override {
+    size_t  wsz = size;
+    while (size) {
+      size_t  n = _size - _len < size ? _size - _len : size;
+      memcpy(_buf + _len, buffer, n);
+      _len += n;
+      buffer += n;
+      size -= n;
+      if (_len == _size)
+        flush();
+    }
+    return wsz;
+  }
+
+  /**
+   * Write the string placed in PROGMEM without copying it to the heap.
+   */
+  size_t  writeP(PGM_P text) {
+    size_t  wsz = 0;
+    char  c;
+    while ((c = pgm_read_byte(text++))) {
+      write(static_cast<uint8_t>(c));
+      wsz++;
+    }
+    return wsz;
+  }
+
+  void  flush(void) {
+    if (_len) {
+      _server.sendContent_P(_buf, _len);
+      _len = 0;
+    }
+  }
+
+ private:
+  T&      _server;  /**< Web server responding */
+  size_t  _size;    /**< Size of the window */
+  size_t  _len;     /**< Length of the content in the window */
+  AutoConnectScratch  _window;  /**< Storage of the window */
+  char*   _buf;     /**< Window */
+  char    _fallback[AUTOCONNECT_CHUNKWINDOW_FALLBACK];  /**< Window if the allocation failed */
+};
+
+#endif // !_AUTOCONNECTCHUNK_H_
@@ -8,6 +8,139 @@
  */
 
 #include "AutoConnectCredential.h"
+#include "AutoConnectStats.h"
+
+/**
+ *  Export all saved credentials to the stream as a backup.
+ *  The output is a compact binary stream that has the same entry
+ *  layout as the credential container. It can be imported by restore
+ *  with only one commit.
+ *   0      7 8                (u)                  (u+16)            (t)
+ *  +--------+-+-----------------+-+--+--+--+----+----+-----------------+--+
+ *  |AC_CREDT|e|ssid\0pass\0bssid|d|ip|gw|nm|dns1|dns2|ssid\0pass\0bssid|\0|
+ *  +--------+-+-----------------+-+--+--+--+----+----+-----------------+--+
+ *  @param  out   An output stream such as File or WiFiClient.
+ *  @retval Number of bytes written.
+ */
+size_t AutoConnectCredentialBase::backup(Print& out) {
+  uint8_t en = entries();
+  uint8_t n = 0;
+  size_t  sz = out.print(F(AC_IDENTIFIER));
+
+  sz += out.write(en);
+  // All entries are written in one pass over the storage. The entries
+  // beyond the count are not written, restore stops at the terminator.
+  _each([&](const station_config_t* config) {
+    if (n < en) {
+      sz += _writeEntry(out, config);
+      n++;
+    }
+  });
+  sz += out.write(static_cast<uint8_t>('\0'));
+  return sz;
+}
+
+/**
+ *  Import the credentials exported by backup. All entries read from the
+ *  stream are merged into the storage with a single commit. The same
+ *  SSID entry that already exists will be replaced.
+ *  @param  in    An input stream that contains the backup image.
+ *  @retval Number of restored entries. 0 is returned if the stream is
+ *  not a valid backup image or the commit failed.
+ */
+uint8_t AutoConnectCredentialBase::restore(Stream& in) {
+  char  id_c[sizeof(AC_IDENTIFIER) - 1];
+
+  if (in.readBytes(id_c, sizeof(id_c)) != sizeof(id_c) || strncmp(id_c, AC_IDENTIFIER, sizeof(id_c))) {
+    AC_DBG("Not a credential backup\n");
+    return 0;
+  }
+  int en = in.read();
+  if (en <= 0)
+    return 0;
+
+  std::vector<station_config_t> credt;
+  credt.reserve(en);
+  while (en--) {
+    station_config_t  config;
+    if (!_readEntry(in, &config))
+      break;
+    credt.push_back(config);
+  }
+  if (!credt.size())
+    return 0;
+  return save(credt.data(), static_cast<uint8_t>(credt.size())) ? static_cast<uint8_t>(credt.size()) : 0;
+}
+
+/**
+ *  Calculate the size occupied by an entry in the container.
+ *  @param  config  A station_config structure pointer.
+ *  @retval Number of bytes of the serialized entry.
+ */
+uint16_t AutoConnectCredentialBase::_entrySize(const station_config_t* config) {
+  uint16_t eSize = strnlen(reinterpret_cast<const char*>(config->ssid), sizeof(station_config_t::ssid)) + strnlen(reinterpret_cast<const char*>(config->password), sizeof(station_config_t::password)) + sizeof(station_config_t::bssid) + sizeof(station_config_t::dhcp);
+  if (config->dhcp == (uint8_t)STA_STATIC)
+    eSize += sizeof(station_config_t::_config);
+  return eSize + sizeof('\0') + sizeof('\0');
+}
+
+/**
+ *  Deserialize an entry from the stream. The static IPs are stored in
+ *  the big-endian as same as the container.
+ *  @param  in      An input stream.
+ *  @param  config  A station_config structure pointer to be stored.
+ *  @retval true    An entry has been read.
+ *  @retval false   The stream has been exhausted.
+ */
+bool AutoConnectCredentialBase::_readEntry(Stream& in, station_config_t* config) {
+  memset(config, 0x00, sizeof(station_config_t));
+  size_t  len = in.readBytesUntil('\0', reinterpret_cast<char*>(config->ssid), sizeof(station_config_t::ssid));
+  if (!len)
+    return false;
+  if (len == sizeof(station_config_t::ssid))
+    in.read();  // Skip the terminator of the SSID that fills up the field
+  len = in.readBytesUntil('\0', reinterpret_cast<char*>(config->password), sizeof(station_config_t::password));
+  if (len == sizeof(station_config_t::password))
+    in.read();
+  if (in.readBytes(config->bssid, sizeof(station_config_t::bssid)) != sizeof(station_config_t::bssid))
+    return false;
+  int dhcp = in.read();
+  if (dhcp < 0)
+    return false;
+  config->dhcp = static_cast<uint8_t>(dhcp);
+  if (config->dhcp == (uint8_t)STA_STATIC) {
+    for (uint8_t e = 0; e < sizeof(station_config_t::_config::addr) / sizeof(uint32_t); e++) {
+      uint8_t ip[sizeof(uint32_t)];
+      if (in.readBytes(ip, sizeof(ip)) != sizeof(ip))
+        return false;
+      config->config.addr[e] = ((uint32_t)ip[0] << 24) | ((uint32_t)ip[1] << 16) | ((uint32_t)ip[2] << 8) | (uint32_t)ip[3];
+    }
+  }
+  return true;
+}
+
+/**
+ *  Serialize an entry to the stream.
+ *  @param  out     An output stream.
+ *  @param  config  A station_config structure pointer to be written.
+ *  @retval Number of bytes written.
+ */
+size_t AutoConnectCredentialBase::_writeEntry(Print& out, const station_config_t* config) {
+  size_t  sz = out.write(config->ssid, strnlen(reinterpret_cast<const char*>(config->ssid), sizeof(station_config_t::ssid)));
+  sz += out.write(static_cast<uint8_t>('\0'));
+  sz += out.write(config->password, strnlen(reinterpret_cast<const char*>(config->password), sizeof(station_config_t::password)));
+  sz += out.write(static_cast<uint8_t>('\0'));
+  sz += out.write(config->bssid, sizeof(station_config_t::bssid));
+  sz += out.write(config->dhcp);
+  if (config->dhcp == (uint8_t)STA_STATIC) {
+    for (uint8_t e = 0; e < sizeof(station_config_t::_config::addr) / sizeof(uint32_t); e++) {
+      uint32_t  ip = config->config.addr[e];
+      for (uint8_t b = 1; b <= sizeof(ip); b++)
+        sz += out.write(((const uint8_t*)&ip)[sizeof(ip) - b]);
+    }
+  }
+  return sz;
+}
 
 #if AC_CREDENTIAL_PREFERENCES == 0
 
@@ -91,6 +224,9 @@ bool AutoConnectCredential::del(const char* ssid) {
   station_config_t  entry;
   bool  rc = false;
 
+  if (!AutoConnectWear::admit(AC_WEARSUBSYS_CREDENTIAL))
+    return false;
+
   if (load(ssid, &entry) >= 0) {
     // Saved credential detected, _ep has the entry location.
     _eeprom->begin(AC_HEADERSIZE + _containSize);
@@ -123,6 +259,7 @@ bool AutoConnectCredential::del(const char* ssid) {
     // commit it.
     rc = _eeprom->commit();
     delay(10);
+    _wear(rc);
     _eeprom->end();
   }
   return rc;
@@ -194,6 +331,9 @@ bool AutoConnectCredential::save(const station_config_t* config) {
   bool    rep = false;
   bool    rc;
 
+  if (!AutoConnectWear::admit(AC_WEARSUBSYS_CREDENTIAL))
+    return false;
+
   // Detect same entry for replacement.
   entry = load(reinterpret_cast<const char*>(config->ssid), &stage);
 
@@ -228,14 +368,8 @@ bool AutoConnectCredential::save(const station_config_t* config) {
     _eeprom->write(i + _offset, _entries);
   }
 
-  rc = _eeprom->commit();
-  delay(10);
-
   // Seek insertion point, evaluate capacity to insert the new entry.
-  uint16_t eSize = strlen(reinterpret_cast<const char*>(config->ssid)) + strlen(reinterpret_cast<const char*>(config->password)) + sizeof(station_config_t::bssid) + sizeof(station_config_t::dhcp);
-  if (config->dhcp == (uint8_t)STA_STATIC)
-    eSize += sizeof(station_config_t::_config);
-  eSize += sizeof('\0') + sizeof('\0');
+  uint16_t eSize = _entrySize(config);
 
   for (_dp = AC_HEADERSIZE; _dp < _containSize + AC_HEADERSIZE; _dp++) {
     uint8_t c = _eeprom->read(_dp);
@@ -252,6 +386,152 @@ bool AutoConnectCredential::save(const station_config_t* config) {
   }
 
   // Save new entry
+  _putEntry(config);
+
+  // Terminate container, mark to the end of credential area.
+  // When the entry is replaced, not mark a terminator.
+  if (!rep) {
+    _eeprom->write(_dp, '\0');
+
+    // Update container size
+    _containSize = _dp - AC_HEADERSIZE;
+    _eeprom->write(_offset + sizeof(AC_IDENTIFIER) - 1 + sizeof(uint8_t), (uint8_t)_containSize);
+    _eeprom->write(_offset + sizeof(AC_IDENTIFIER) - 1 + sizeof(uint8_t) + 1, (uint8_t)(_containSize >> 8));
+  }
+
+  // The release of the replaced entry and the new entry are written
+  // back with one commit, the sector is erased once.
+  rc = _eeprom->commit();
+  delay(10);
+  _wear(rc);
+  _eeprom->end();
+
+  return rc;
+}
+
+/**
+ *  Save multiple credentials to EEPROM at once.
+ *  The current entries and the new entries are merged and written
+ *  back to the container with a single commit. The same SSID entry
+ *  will be replaced. The container is compacted by the rewrite, the
+ *  free areas filled with FF are no longer present.
+ *  @param  config  An array of the station_config structure to be saved.
+ *  @param  num     Number of elements in the array.
+ *  @retval true    Successfully saved.
+ *  @retval false   EEPROM commit failed, or the merged entries exceed
+ *  the container. The storage is not changed then.
+ */
+bool AutoConnectCredential::save(const station_config_t* config, const uint8_t num) {
+  static const char _id[] = AC_IDENTIFIER;
+  std::vector<station_config_t> credt;
+  bool  rc;
+
+  if (!AutoConnectWear::admit(AC_WEARSUBSYS_CREDENTIAL))
+    return false;
+
+  // Retrieve all current entries.
+  credt.reserve(_entries + num);
+  if (_entries) {
+    _eeprom->begin(AC_HEADERSIZE + _containSize);
+    _dp = AC_HEADERSIZE;
+    for (uint8_t i = 0; i < _entries; i++) {
+      station_config_t  entry;
+      _retrieveEntry(&entry);
+      credt.push_back(entry);
+    }
+    _eeprom->end();
+  }
+
+  // Merge the new entries, the same SSID will be replaced.
+  for (uint8_t n = 0; n < num; n++) {
+    const char* ssid = reinterpret_cast<const char*>(config[n].ssid);
+    if (!strlen(ssid))
+      continue;
+    decltype(credt)::iterator it = credt.begin();
+    while (it != credt.end()) {
+      if (!strncmp(ssid, reinterpret_cast<const char*>(it->ssid), sizeof(station_config_t::ssid)))
+        break;
+      ++it;
+    }
+    if (it != credt.end())
+      memcpy(&(*it), &config[n], sizeof(station_config_t));
+    else
+      credt.push_back(config[n]);
+  }
+  // The merged entries must fit the container, nothing is dropped.
+  if (credt.size() > UINT8_MAX) {
+    AC_DBG("%d credentials exceed the container\n", (int)credt.size());
+    return false;
+  }
+  size_t  cSize = 0;
+  for (const station_config_t& entry : credt)
+    cSize += _entrySize(&entry);
+  if (AC_HEADERSIZE + cSize + sizeof('\0') > AC_EEPROM_CAPACITY) {
+    AC_DBG("Credentials %d(B) exceed the EEPROM capacity\n", (int)(AC_HEADERSIZE + cSize + sizeof('\0')));
+    return false;
+  }
+
+  // Rebuild the container.
+  _eeprom->begin(AC_HEADERSIZE + cSize + sizeof('\0'));
+  int i;
+  for (i = 0; i < static_cast<int>(sizeof(_id)) - 1; i++)
+    _eeprom->write(i + _offset, (uint8_t)_id[i]);
+  _entries = static_cast<uint8_t>(credt.size());
+  _eeprom->write(i + _offset, _entries);
+  _dp = AC_HEADERSIZE;
+  for (const station_config_t& entry : credt)
+    _putEntry(&entry);
+  _eeprom->write(_dp, '\0');
+  _containSize = _dp - AC_HEADERSIZE;
+  _eeprom->write(_offset + sizeof(AC_IDENTIFIER) - 1 + sizeof(uint8_t), (uint8_t)_containSize);
+  _eeprom->write(_offset + sizeof(AC_IDENTIFIER) - 1 + sizeof(uint8_t) + 1, (uint8_t)(_containSize >> 8));
+
+  // Only one commit for all entries.
+  rc = _eeprom->commit();
+  delay(10);
+  _wear(rc);
+  _eeprom->end();
+  AC_DBG("%d credential(s) saved with a commit %s\n", (int)_entries, rc ? "" : "failed");
+  return rc;
+}
+
+/**
+ *  Retrieve all entries with one sequential read of the container.
+ *  @param  handler Function called with each entry.
+ *  @retval Number of the entries enumerated.
+ */
+uint8_t AutoConnectCredential::_each(EntryHandlerFT handler) {
+  if (!_entries)
+    return 0;
+  _eeprom->begin(AC_HEADERSIZE + _containSize);
+  _dp = AC_HEADERSIZE;
+  for (uint8_t i = 0; i < _entries; i++) {
+    station_config_t  entry;
+    _retrieveEntry(&entry);
+    handler(&entry);
+  }
+  _eeprom->end();
+  return _entries;
+}
+
+/**
+ *  Account a commit of the EEPROM. The EEPROM emulation writes back
+ *  the whole buffer to the sector every commit.
+ *  @param  committed The commit result.
+ */
+void AutoConnectCredential::_wear(const bool committed) {
+  if (committed) {
+    AutoConnectWear::write(AC_WEARSUBSYS_CREDENTIAL, AC_WEARREGION_EEPROM, _eeprom->length(), AUTOCONNECT_WEAR_SECTOR);
+    AutoConnectWear::commit(AC_WEARSUBSYS_CREDENTIAL, AC_WEARREGION_EEPROM);
+  }
+}
+
+/**
+ *  Write an entry to EEPROM from the current address indicated by _dp.
+ *  The static IPs are stored in the big-endian.
+ *  @param  config  A pointer to the station_config structure storing SSID and password.
+ */
+void AutoConnectCredential::_putEntry(const station_config_t* config) {
   uint8_t         c;
   const uint8_t*  dt;
   dt = config->ssid;
@@ -274,23 +554,6 @@ bool AutoConnectCredential::save(const station_config_t* config) {
         _eeprom->write(_dp++, ((uint8_t*)&ip)[sizeof(ip) - b]);
     }
   }
-
-  // Terminate container, mark to the end of credential area.
-  // When the entry is replaced, not mark a terminator.
-  if (!rep) {
-    _eeprom->write(_dp, '\0');
-
-    // Update container size
-    _containSize = _dp - AC_HEADERSIZE;
-    _eeprom->write(_offset + sizeof(AC_IDENTIFIER) - 1 + sizeof(uint8_t), (uint8_t)_containSize);
-    _eeprom->write(_offset + sizeof(AC_IDENTIFIER) - 1 + sizeof(uint8_t) + 1, (uint8_t)(_containSize >> 8));
-  }
-
-  rc &= _eeprom->commit();
-  delay(10);
-  _eeprom->end();
-
-  return rc;
 }
 
 /**
@@ -463,6 +726,29 @@ bool AutoConnectCredential::save(const station_config_t* config) {
   return false;
 }
 
+/**
+ *  Save multiple credentials to Preferences at once.
+ *  All entries are added to the internal dictionary and written back
+ *  to the nvs with a single commit.
+ *  @param  config  An array of the station_config structure to be saved.
+ *  @param  num     Number of elements in the array.
+ *  @retval true    Successfully saved.
+ *  @retval false   Preferences commit failed, or the merged entries
+ *  exceed the container. The nvs is not changed then.
+ */
+bool AutoConnectCredential::save(const station_config_t* config, const uint8_t num) {
+  bool  rc = true;
+  for (uint8_t n = 0; n < num; n++)
+    rc &= _add(&config[n]);
+  // The merged entries must fit the container, nothing is dropped.
+  if (_credit.size() > UINT8_MAX) {
+    AC_DBG("%d credentials exceed the container\n", (int)_credit.size());
+    _entries = _import();
+    return false;
+  }
+  return _commit() > 0 ? rc : false;
+}
+
 /**
  *  Add an entry to internal dictionary that is std::map structure.
  *  It adds an entry by the insert after will delete the same entry
@@ -520,6 +806,10 @@ size_t AutoConnectCredential::_commit(void) {
   // Calculate the nvs pool size for saving to NVS. Add size of 'e' and 'ss' field.
   size_t  psz = _containSize + sizeof(uint8_t) + sizeof(uint16_t);
 
+  // The write back is subject to the rate limit.
+  if (!AutoConnectWear::admit(AC_WEARSUBSYS_CREDENTIAL))
+    return 0;
+
   // Dump container to serialization pool and write it back to NVS.
   uint8_t* credtPool = (uint8_t*)malloc(psz);
   if (credtPool) {
@@ -558,6 +848,10 @@ size_t AutoConnectCredential::_commit(void) {
     if (_pref->begin(AC_CREDENTIAL_NVSNAME, false)) {
       sz = _pref->putBytes(AC_CREDENTIAL_NVSKEY, credtPool, psz);
       _pref->end();
+      if (sz) {
+        AutoConnectWear::write(AC_WEARSUBSYS_CREDENTIAL, AC_WEARREGION_NVS, sz);
+        AutoConnectWear::commit(AC_WEARSUBSYS_CREDENTIAL, AC_WEARREGION_NVS);
+      }
     }
     #ifdef AC_DBG
     else {
@@ -656,6 +950,23 @@ uint8_t AutoConnectCredential::_import(void) {
   return cn;
 }
 
+/**
+ *  Enumerate all entries of the dictionary imported once.
+ *  @param  handler Function called with each entry.
+ *  @retval Number of the entries enumerated.
+ */
+uint8_t AutoConnectCredential::_each(EntryHandlerFT handler) {
+  uint8_t n = 0;
+  _entries = _import();
+  for (decltype(_credit)::iterator it = _credit.begin(), e = _credit.end(); it != e; ++it) {
+    station_config_t  entry;
+    _obtain(it, &entry);
+    handler(&entry);
+    n++;
+  }
+  return n;
+}
+
 /**
  *  Obtains an entry pointed to by the specified iterator from the
  *  dictionary as the std::map that maintains the credentials into the
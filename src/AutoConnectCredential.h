@@ -20,6 +20,8 @@
 
 #include <Arduino.h>
 #include <memory>
+#include <vector>
+#include <functional>
 #if defined(ARDUINO_ARCH_ESP8266)
 #define AC_CREDENTIAL_PREFERENCES 0
 extern "C" {
@@ -44,6 +46,14 @@ extern "C" {
 #define AC_IDENTIFIER_OFFSET  0
 #endif
 
+/**
+ * Capacity of the EEPROM area that can hold the credentials, which is
+ * one sector of the flash emulating the EEPROM.
+ */
+#ifndef AC_EEPROM_CAPACITY
+#define AC_EEPROM_CAPACITY  4096
+#endif
+
 /**
  * Storage identifier for AutoConnect credentials. It is global constant
  * and reserved.
@@ -84,9 +94,17 @@ class AutoConnectCredentialBase {
   virtual int8_t  load(const char* ssid, station_config_t* config) = 0;
   virtual bool    load(int8_t entry, station_config_t* config) = 0;
   virtual bool    save(const station_config_t* config) = 0;
+  virtual bool    save(const station_config_t* config, const uint8_t num) = 0;
+  size_t  backup(Print& out);
+  uint8_t restore(Stream& in);
 
  protected:
   virtual void  _allocateEntry(void) = 0; /**< Initialize storage for credentials. */
+  static uint16_t _entrySize(const station_config_t* config); /**< Serialized size of an entry */
+  static bool   _readEntry(Stream& in, station_config_t* config); /**< Deserialize an entry from the stream */
+  static size_t _writeEntry(Print& out, const station_config_t* config); /**< Serialize an entry to the stream */
+  typedef std::function<void(const station_config_t*)>  EntryHandlerFT;
+  virtual uint8_t _each(EntryHandlerFT handler) = 0;  /**< Enumerate all entries in one pass */
 
   uint8_t   _entries;       /**< Count of the available entry */
   uint16_t  _containSize;   /**< Container size */
@@ -107,12 +125,16 @@ class AutoConnectCredential : public AutoConnectCredentialBase {
   int8_t  load(const char* ssid, station_config_t* config) override;
   bool    load(int8_t entry, station_config_t* config) override;
   bool    save(const station_config_t* config) override;
+  bool    save(const station_config_t* config, const uint8_t num) override;
 
  protected:
   void    _allocateEntry(void) override;  /**< Initialize storage for credentials. */
+  uint8_t _each(EntryHandlerFT handler) override;
 
  private:
+  void    _putEntry(const station_config_t* config);  /**< Write an entry. */
   void    _retrieveEntry(station_config_t* config);   /**< Read an available entry. */
+  void    _wear(const bool committed);            /**< Account a commit. */
 
   int       _dp;            /**< The current address in EEPROM */
   int       _ep;            /**< The current entry address in EEPROM */
@@ -146,9 +168,11 @@ class AutoConnectCredential : public AutoConnectCredentialBase {
   int8_t  load(const char* ssid, station_config_t* config) override;
   bool    load(int8_t entry, station_config_t* config) override;
   bool    save(const station_config_t* config) override;
+  bool    save(const station_config_t* config, const uint8_t num) override;
 
  protected:
   void    _allocateEntry(void) override;  /**< Initialize storage for credentials. */
+  uint8_t _each(EntryHandlerFT handler) override;
 
  private:
   typedef struct {
@@ -0,0 +1,178 @@
+/**
+ *  AutoConnectDNS class implementation.
+ *  It drains the pending queries up to a budget per call and answers
+ *  them from the precomputed response, instead of building the answer
+ *  for each query.
+ *  @file   AutoConnectDNS.cpp
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#include "AutoConnectDNS.h"
+
+/**
+ *  Start the DNS responder. The answer record is built here once.
+ *  @param  port  UDP port to listen.
+ *  @param  ip    IP address to be answered for every A query.
+ *  @param  ttl   TTL of the answer [s].
+ *  @return true  The responder started.
+ */
+bool AutoConnectDNS::start(const uint16_t port, const IPAddress& ip, const uint32_t ttl) {
+  // The answer record refers to the name in the question by the
+  // compression pointer, so it is the same for every query.
+  const uint8_t answer[AC_DNS_ANSWERSIZE] = {
+    0xc0, 0x0c,                             // Name: pointer to offset 12
+    0x00, 0x01,                             // Type: A
+    0x00, 0x01,                             // Class: IN
+    static_cast<uint8_t>(ttl >> 24), static_cast<uint8_t>(ttl >> 16),
+    static_cast<uint8_t>(ttl >> 8), static_cast<uint8_t>(ttl),
+    0x00, 0x04,                             // RDLENGTH
+    ip[0], ip[1], ip[2], ip[3]
+  };
+  memcpy(_answer, answer, sizeof(_answer));
+  memset(_clients, 0x00, sizeof(_clients));
+  _queries = _limited = 0;
+  stop();
+  _running = _udp.begin(port) == 1;
+  return _running;
+}
+
+/**
+ *  Stop the DNS responder.
+ */
+void AutoConnectDNS::stop(void) {
+  if (_running) {
+    _udp.stop();
+    _running = false;
+  }
+}
+
+/**
+ *  Process the pending queries up to the budget.
+ *  @param  budget  Maximum number of the queries to be processed.
+ *  @return Number of the processed queries.
+ */
+uint16_t AutoConnectDNS::processNextRequest(const uint16_t budget) {
+  uint16_t  processed = 0;
+
+  if (!_running)
+    return 0;
+
+  while (processed < budget) {
+    int len = _udp.parsePacket();
+    if (len <= 0)
+      break;
+    processed++;
+    _queries++;
+    // The unread packet is discarded by the next parsePacket.
+    if (len < AC_DNS_HEADERSIZE || len > AC_DNS_PACKETSIZE)
+      continue;
+    if (!_admit(static_cast<uint32_t>(_udp.remoteIP()), millis())) {
+      _limited++;
+      continue;
+    }
+    _udp.read(_packet, len);
+    _respond(static_cast<size_t>(len));
+  }
+  return processed;
+}
+
+/**
+ *  Count the query in the 1-second window of the client and judge
+ *  whether it is within the rate limit. When the table is full, the
+ *  client with the oldest window is replaced.
+ *  @param  ip    IP address of the client.
+ *  @param  now   Current millis.
+ *  @return true  The query is admitted.
+ */
+bool AutoConnectDNS::_admit(const uint32_t ip, const unsigned long now) {
+#if AUTOCONNECT_DNS_RATELIMIT > 0
+  AC_DNSCLIENT_t* slot = &_clients[0];
+
+  for (AC_DNSCLIENT_t& client : _clients) {
+    if (client.ip == ip) {
+      slot = &client;
+      break;
+    }
+    if (now - client.window > now - slot->window)
+      slot = &client;
+  }
+  if (slot->ip != ip || now - slot->window >= 1000) {
+    slot->ip = ip;
+    slot->window = now;
+    slot->count = 0;
+  }
+  return ++slot->count <= AUTOCONNECT_DNS_RATELIMIT;
+#else
+  AC_UNUSED(ip);
+  AC_UNUSED(now);
+  return true;
+#endif
+}
+
+/**
+ *  Turn the query in the packet buffer into the response and send it.
+ *  An A or ANY query of IN class gets the precomputed answer. The other
+ *  types such as AAAA get an empty NOERROR response at once. A standard
+ *  query without exactly one question or with an unparsable question
+ *  name, including a compression pointer, gets FORMERR, and the other
+ *  opcodes get NOTIMP. The additional records of the query, like EDNS
+ *  OPT, are not echoed back.
+ *  @param  len   Length of the query.
+ *  @return true  The response has been sent.
+ */
+bool AutoConnectDNS::_respond(const size_t len) {
+  uint8_t*  hdr = _packet;
+
+  // Ignore the responses.
+  if (hdr[2] & 0x80)
+    return false;
+
+  uint8_t opcode = (hdr[2] >> 3) & 0x0f;
+  uint16_t  qdcount = (hdr[4] << 8) | hdr[5];
+  size_t  end = AC_DNS_HEADERSIZE;
+  uint16_t  ancount = 0;
+  uint8_t rcode = AC_DNS_RCODE_NOERROR;
+
+  if (opcode != 0)
+    rcode = AC_DNS_RCODE_NOTIMP;
+  else if (qdcount != 1)
+    rcode = AC_DNS_RCODE_FORMERR;
+  else {
+    // Skip the labels of the question name.
+    while (end < len && _packet[end] && !(_packet[end] & 0xc0))
+      end += _packet[end] + 1;
+    if (end >= len || _packet[end])
+      rcode = AC_DNS_RCODE_FORMERR;
+    else if ((end += 1 + 4) > len)  // Terminator, QTYPE and QCLASS
+      rcode = AC_DNS_RCODE_FORMERR;
+    else {
+      uint16_t  qtype = (_packet[end - 4] << 8) | _packet[end - 3];
+      uint16_t  qclass = (_packet[end - 2] << 8) | _packet[end - 1];
+      if ((qtype == AC_DNS_QTYPE_A || qtype == AC_DNS_QTYPE_ANY) && qclass == AC_DNS_QCLASS_IN) {
+        memcpy(&_packet[end], _answer, sizeof(_answer));
+        end += sizeof(_answer);
+        ancount = 1;
+      }
+    }
+  }
+  if (rcode != AC_DNS_RCODE_NOERROR) {
+    // Echo only the header.
+    end = AC_DNS_HEADERSIZE;
+    qdcount = 0;
+  }
+
+  hdr[2] = 0x80 | (hdr[2] & 0x79) | 0x04;   // QR, keep opcode and RD, AA
+  hdr[3] = 0x80 | rcode;                    // RA
+  hdr[4] = qdcount >> 8;
+  hdr[5] = qdcount & 0xff;
+  hdr[6] = ancount >> 8;
+  hdr[7] = ancount & 0xff;
+  hdr[8] = hdr[9] = hdr[10] = hdr[11] = 0;  // NSCOUNT, ARCOUNT
+
+  _udp.beginPacket(_udp.remoteIP(), _udp.remotePort());
+  _udp.write(_packet, end);
+  return _udp.endPacket() == 1;
+}
@@ -0,0 +1,65 @@
+/**
+ *  Declaration of AutoConnectDNS class.
+ *  The DNS responder for the captive portal which answers every A query
+ *  with the SoftAP IP address.
+ *  @file   AutoConnectDNS.h
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTDNS_H_
+#define _AUTOCONNECTDNS_H_
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include "AutoConnectDefs.h"
+
+// Maximum size of a DNS message over UDP without EDNS
+#define AC_DNS_PACKETSIZE   512
+
+// Size of the fixed DNS header
+#define AC_DNS_HEADERSIZE   12
+
+// Size of the precomputed answer record
+#define AC_DNS_ANSWERSIZE   16
+
+// Query types, class and response codes
+#define AC_DNS_QTYPE_A      1
+#define AC_DNS_QTYPE_ANY    255
+#define AC_DNS_QCLASS_IN    1
+#define AC_DNS_RCODE_NOERROR  0
+#define AC_DNS_RCODE_FORMERR  1
+#define AC_DNS_RCODE_NOTIMP   4
+
+class AutoConnectDNS {
+ public:
+  AutoConnectDNS() : _running(false), _queries(0), _limited(0) {}
+  ~AutoConnectDNS() { stop(); }
+  bool  start(const uint16_t port, const IPAddress& ip, const uint32_t ttl = AUTOCONNECT_DNS_TTL);
+  void  stop(void);
+  uint16_t  processNextRequest(const uint16_t budget = AUTOCONNECT_DNS_BUDGET);
+  uint32_t  queries(void) const { return _queries; }
+  uint32_t  limited(void) const { return _limited; }
+
+ protected:
+  /** Query counter for the rate limit of a client */
+  typedef struct {
+    uint32_t  ip;           /**< Client IP address */
+    uint32_t  window;       /**< Start of the current 1-second window */
+    uint16_t  count;        /**< Queries in the current window */
+  } AC_DNSCLIENT_t;
+
+  bool  _admit(const uint32_t ip, const unsigned long now);
+  bool  _respond(const size_t len);
+  WiFiUDP   _udp;
+  bool      _running;
+  uint8_t   _answer[AC_DNS_ANSWERSIZE];   /**< Precomputed A record */
+  uint8_t   _packet[AC_DNS_PACKETSIZE + AC_DNS_ANSWERSIZE]; /**< Query and response */
+  AC_DNSCLIENT_t  _clients[AUTOCONNECT_DNS_CLIENTS];
+  uint32_t  _queries;       /**< Number of the received queries */
+  uint32_t  _limited;       /**< Number of the queries dropped by the rate limit */
+};
+
+#endif // !_AUTOCONNECTDNS_H_
@@ -34,6 +34,49 @@
 #define AUTOCONNECT_USE_UPDATE
 #endif
 
+// Indicator of whether to record the portal metrics and to serve them
+// at AUTOCONNECT_URI_METRICS. Uncomment or define it externally.
+//#define AUTOCONNECT_USE_METRICS
+
+// Uncomment the following AC_HEAPTRACE to trace the heap allocations
+// per request. It also requires the linker options to wrap the allocator:
+// -Wl,--wrap=malloc,--wrap=free,--wrap=realloc,--wrap=calloc
+//#define AC_HEAPTRACE
+
+// Indicator of whether to record the binary trace events into the ring
+// buffer, which are served at AUTOCONNECT_URI_TRACE and drained to
+// AC_DEBUG_PORT at idle. Uncomment or define it externally.
+//#define AUTOCONNECT_USE_TRACE
+
+// Indicator of whether to stream the configuration page through the
+// fixed-size chunk window instead of the reserved content buffer, which
+// makes its memory independent of the number of the networks found.
+// Uncomment or define it externally.
+//#define AUTOCONNECT_USE_STREAMCONFIG
+
+// Indicator of whether to serve the JSON status and control API of the
+// portal under AUTOCONNECT_URI_API. Uncomment or define it externally.
+//#define AUTOCONNECT_USE_JSONAPI
+
+// Indicator of whether to serve the precompressed single-page front end
+// that consumes the JSON API at AUTOCONNECT_URI_APP. It is generated to
+// AutoConnectSPA.h by acspa/mkspa.py. Uncomment or define it externally.
+//#define AUTOCONNECT_USE_SPA
+#if defined(AUTOCONNECT_USE_SPA) && !defined(AUTOCONNECT_USE_JSONAPI)
+#define AUTOCONNECT_USE_JSONAPI
+#endif
+
+// Indicator of whether to push the connection state, the scan completion
+// and the update progress to the browsers subscribed to the event stream
+// at AUTOCONNECT_URI_EVENTS. Uncomment or define it externally.
+//#define AUTOCONNECT_USE_EVENTS
+
+// Indicator of whether to take the temporary buffers of the page
+// rendering from the static arena of AUTOCONNECT_ARENA_SIZE, which is
+// reset after each request, instead of the heap. Uncomment or define it
+// externally.
+//#define AUTOCONNECT_USE_ARENA
+
 // SPIFFS has deprecated on EP8266 core. This flag indicates that
 // the migration to LittleFS has not completed.
 //#define AC_USE_SPIFFS
@@ -122,6 +165,31 @@
 #define AUTOCONNECT_URI_UPDATE_PROGRESS AUTOCONNECT_URI "/update_progress"
 #define AUTOCONNECT_URI_UPDATE_RESULT   AUTOCONNECT_URI "/update_result"
 
+// URI of the metrics endpoint, valid with AUTOCONNECT_USE_METRICS
+#ifndef AUTOCONNECT_URI_METRICS
+#define AUTOCONNECT_URI_METRICS AUTOCONNECT_URI "/metrics"
+#endif // !AUTOCONNECT_URI_METRICS
+
+// URI of the trace dump endpoint, valid with AUTOCONNECT_USE_TRACE
+#ifndef AUTOCONNECT_URI_TRACE
+#define AUTOCONNECT_URI_TRACE AUTOCONNECT_URI "/trace"
+#endif // !AUTOCONNECT_URI_TRACE
+
+// Base URI of the JSON API, valid with AUTOCONNECT_USE_JSONAPI
+#ifndef AUTOCONNECT_URI_API
+#define AUTOCONNECT_URI_API AUTOCONNECT_URI "/api"
+#endif // !AUTOCONNECT_URI_API
+
+// URI of the single-page front end, valid with AUTOCONNECT_USE_SPA
+#ifndef AUTOCONNECT_URI_APP
+#define AUTOCONNECT_URI_APP AUTOCONNECT_URI "/app"
+#endif // !AUTOCONNECT_URI_APP
+
+// URI of the event stream, valid with AUTOCONNECT_USE_EVENTS
+#ifndef AUTOCONNECT_URI_EVENTS
+#define AUTOCONNECT_URI_EVENTS  AUTOCONNECT_URI "/events"
+#endif // !AUTOCONNECT_URI_EVENTS
+
 // Number of seconds in uint time [s]
 #ifndef AUTOCONNECT_UNITTIME
 #define AUTOCONNECT_UNITTIME    30
@@ -132,6 +200,122 @@
 #define AUTOCONNECT_TIMEOUT     30000
 #endif // !AUTOCONNECT_TIMEOUT
 
+// Maximum time that AutoConnect::beginAsync spends in one handleClient [ms]
+#ifndef AUTOCONNECT_ASYNC_BUDGET
+#define AUTOCONNECT_ASYNC_BUDGET  5
+#endif // !AUTOCONNECT_ASYNC_BUDGET
+
+// Number of candidates retained by the failover of the autoReconnect
+#ifndef AUTOCONNECT_CANDIDATES
+#define AUTOCONNECT_CANDIDATES    8
+#endif // !AUTOCONNECT_CANDIDATES
+
+// Ceiling of the reconnection interval by the backoff, in unit time
+#ifndef AUTOCONNECT_RECONNECT_CEILING
+#define AUTOCONNECT_RECONNECT_CEILING 120
+#endif // !AUTOCONNECT_RECONNECT_CEILING
+
+// Improvement of RSSI required for roaming to another BSSID [dB]
+#ifndef AUTOCONNECT_ROAM_HYSTERESIS
+#define AUTOCONNECT_ROAM_HYSTERESIS   8
+#endif // !AUTOCONNECT_ROAM_HYSTERESIS
+
+// Minimum interval of the scan for roaming [s]
+#ifndef AUTOCONNECT_ROAM_INTERVAL
+#define AUTOCONNECT_ROAM_INTERVAL     60
+#endif // !AUTOCONNECT_ROAM_INTERVAL
+
+// Sampling period of RSSI for roaming [ms]
+#ifndef AUTOCONNECT_ROAM_SAMPLING
+#define AUTOCONNECT_ROAM_SAMPLING     1000
+#endif // !AUTOCONNECT_ROAM_SAMPLING
+
+// Number of partial scan plans before the full sweep is forced
+#ifndef AUTOCONNECT_FULLSCAN_INTERVAL
+#define AUTOCONNECT_FULLSCAN_INTERVAL 4
+#endif // !AUTOCONNECT_FULLSCAN_INTERVAL
+
+// Maximum period that handleClient skips the full pass while idle [ms]
+#ifndef AUTOCONNECT_IDLE_REFRESH
+#define AUTOCONNECT_IDLE_REFRESH  100
+#endif // !AUTOCONNECT_IDLE_REFRESH
+
+// Maximum sleep slice while waiting for the WiFi event, the web server
+// and the DNS server are serviced between slices [ms]
+#ifndef AUTOCONNECT_EVENT_SLICE
+#define AUTOCONNECT_EVENT_SLICE   10
+#endif // !AUTOCONNECT_EVENT_SLICE
+
+// Capacity of the queue conveying the WiFi events to handleRequest,
+// must be a power of two
+#ifndef AUTOCONNECT_EVENTQUEUE_SIZE
+#define AUTOCONNECT_EVENTQUEUE_SIZE 8
+#endif // !AUTOCONNECT_EVENTQUEUE_SIZE
+
+// Number of the records held by the trace ring buffer, valid with
+// AUTOCONNECT_USE_TRACE. A power of two is preferable.
+#ifndef AUTOCONNECT_TRACE_SIZE
+#define AUTOCONNECT_TRACE_SIZE  128
+#endif // !AUTOCONNECT_TRACE_SIZE
+
+// Maximum number of the trace records drained to AC_DEBUG_PORT per
+// idle pass of handleRequest, 0 disables the drain
+#ifndef AUTOCONNECT_TRACE_DRAIN
+#define AUTOCONNECT_TRACE_DRAIN 4
+#endif // !AUTOCONNECT_TRACE_DRAIN
+
+// Maximum number of the browsers subscribed to the event stream at the
+// same time, valid with AUTOCONNECT_USE_EVENTS
+#ifndef AUTOCONNECT_EVENTS_CLIENTS
+#define AUTOCONNECT_EVENTS_CLIENTS  2
+#endif // !AUTOCONNECT_EVENTS_CLIENTS
+
+// Interval of the comment line that keeps the event stream alive [ms]
+#ifndef AUTOCONNECT_EVENTS_KEEPALIVE
+#define AUTOCONNECT_EVENTS_KEEPALIVE  15000
+#endif // !AUTOCONNECT_EVENTS_KEEPALIVE
+
+// Minimum interval of the progress events pushed [ms]
+#ifndef AUTOCONNECT_EVENTS_INTERVAL
+#define AUTOCONNECT_EVENTS_INTERVAL 250
+#endif // !AUTOCONNECT_EVENTS_INTERVAL
+
+// Size of the scratch arena for the page rendering, valid with
+// AUTOCONNECT_USE_ARENA [bytes]
+#ifndef AUTOCONNECT_ARENA_SIZE
+#define AUTOCONNECT_ARENA_SIZE  2048
+#endif // !AUTOCONNECT_ARENA_SIZE
+
+// Stack size of the dedicated portal task, only for ESP32 [bytes]
+#ifndef AUTOCONNECT_TASK_STACKSIZE
+#define AUTOCONNECT_TASK_STACKSIZE  8192
+#endif // !AUTOCONNECT_TASK_STACKSIZE
+
+// Priority of the dedicated portal task
+#ifndef AUTOCONNECT_TASK_PRIORITY
+#define AUTOCONNECT_TASK_PRIORITY   1
+#endif // !AUTOCONNECT_TASK_PRIORITY
+
+// CPU core to which the dedicated portal task is pinned
+#ifndef AUTOCONNECT_TASK_CORE
+#define AUTOCONNECT_TASK_CORE       tskNO_AFFINITY
+#endif // !AUTOCONNECT_TASK_CORE
+
+// Cycle of the dedicated portal task, also used as the lock wait [ms]
+#ifndef AUTOCONNECT_TASK_INTERVAL
+#define AUTOCONNECT_TASK_INTERVAL   2
+#endif // !AUTOCONNECT_TASK_INTERVAL
+
+// Time-out limitation of the fast reconnect with the cached lease [ms]
+#ifndef AUTOCONNECT_FASTRECONNECT_TIMEOUT
+#define AUTOCONNECT_FASTRECONNECT_TIMEOUT 3000
+#endif // !AUTOCONNECT_FASTRECONNECT_TIMEOUT
+
+// Number of fast reconnects with the same lease before renewing by DHCP
+#ifndef AUTOCONNECT_FASTRECONNECT_RENEW
+#define AUTOCONNECT_FASTRECONNECT_RENEW   16
+#endif // !AUTOCONNECT_FASTRECONNECT_RENEW
+
 // Captive portal timeout value [ms]
 #ifndef AUTOCONNECT_CAPTIVEPORTAL_TIMEOUT
 #define AUTOCONNECT_CAPTIVEPORTAL_TIMEOUT 0
@@ -157,6 +341,26 @@
 #define AUTOCONNECT_DNSPORT     53
 #endif // !AUTOCONNECT_DNSPORT
 
+// Maximum number of DNS queries processed per handleClient
+#ifndef AUTOCONNECT_DNS_BUDGET
+#define AUTOCONNECT_DNS_BUDGET  16
+#endif // !AUTOCONNECT_DNS_BUDGET
+
+// TTL of the captive DNS answer [s]
+#ifndef AUTOCONNECT_DNS_TTL
+#define AUTOCONNECT_DNS_TTL     60
+#endif // !AUTOCONNECT_DNS_TTL
+
+// Maximum DNS queries per second from a client, 0 means unlimited
+#ifndef AUTOCONNECT_DNS_RATELIMIT
+#define AUTOCONNECT_DNS_RATELIMIT 20
+#endif // !AUTOCONNECT_DNS_RATELIMIT
+
+// Number of clients tracked by the DNS rate limit
+#ifndef AUTOCONNECT_DNS_CLIENTS
+#define AUTOCONNECT_DNS_CLIENTS 16
+#endif // !AUTOCONNECT_DNS_CLIENTS
+
 // http response transfer method
 #ifndef AUTOCONNECT_HTTP_TRANSFER
 #define AUTOCONNECT_HTTP_TRANSFER PB_ByteStream
@@ -167,11 +371,45 @@
 #define AUTOCONNECT_CONTENTBUFFER_SIZE  (13 * 1024)
 #endif // !AUTOCONNECT_CONTENTBUFFER_SIZE
 
+// Size of the chunk window to stream the page, valid with
+// AUTOCONNECT_USE_STREAMCONFIG
+#ifndef AUTOCONNECT_CHUNKWINDOW_SIZE
+#define AUTOCONNECT_CHUNKWINDOW_SIZE    1024
+#endif // !AUTOCONNECT_CHUNKWINDOW_SIZE
+
+// Size of the chunk window on the stack when the window cannot be
+// allocated
+#ifndef AUTOCONNECT_CHUNKWINDOW_FALLBACK
+#define AUTOCONNECT_CHUNKWINDOW_FALLBACK  128
+#endif // !AUTOCONNECT_CHUNKWINDOW_FALLBACK
+
 // Number of unit lines in the page that lists available SSIDs
 #ifndef AUTOCONNECT_SSIDPAGEUNIT_LINES
 #define AUTOCONNECT_SSIDPAGEUNIT_LINES  5
 #endif // !AUTOCONNECT_SSIDPAGEUNIT_LINES
 
+// Free heap below which the portal renders in the low memory mode [bytes]
+// 0 disables the evaluation, such as 8192
+#ifndef AUTOCONNECT_HEAP_WATERMARK
+#define AUTOCONNECT_HEAP_WATERMARK      0
+#endif // !AUTOCONNECT_HEAP_WATERMARK
+
+// Largest free block below which the portal renders in the low memory mode [bytes]
+// 0 disables the evaluation, such as 4096
+#ifndef AUTOCONNECT_BLOCK_WATERMARK
+#define AUTOCONNECT_BLOCK_WATERMARK     0
+#endif // !AUTOCONNECT_BLOCK_WATERMARK
+
+// Number of unit lines of the SSID list in the low memory mode
+#ifndef AUTOCONNECT_SSIDPAGEUNIT_LOWMEMORY
+#define AUTOCONNECT_SSIDPAGEUNIT_LOWMEMORY  2
+#endif // !AUTOCONNECT_SSIDPAGEUNIT_LOWMEMORY
+
+// Retry-After of the request refused in the low memory mode [s]
+#ifndef AUTOCONNECT_LOWMEMORY_RETRY
+#define AUTOCONNECT_LOWMEMORY_RETRY     5
+#endif // !AUTOCONNECT_LOWMEMORY_RETRY
+
 // SPI transfer speed for SD [Hz]
 #ifndef AUTOCONNECT_SD_SPEED
 #define AUTOCONNECT_SD_SPEED    4000000
@@ -18,6 +18,7 @@
 #include <regex>
 #endif
 #include "AutoConnectElementBasis.h"
+#include "AutoConnectArena.h"
 
 // Preserve a valid global Filesystem instance.
 // It allows the interface to the actual filesystem for migration to LittleFS.
@@ -362,11 +363,10 @@ const String AutoConnectTextBasis::toHTML(void) const {
     html += String(">");
     if (format.length()) {
       int   buflen = (value.length() + format.length() + 16 + 1) & (~0xf);
-      char* buffer;
-      if ((buffer = (char*)malloc(buflen))) {
-        snprintf(buffer, buflen, format.c_str(), value.c_str());
-        value_f = String(buffer);
-        free(buffer);
+      AutoConnectScratch  buffer(buflen);
+      if (buffer.get()) {
+        snprintf(buffer.get(), buflen, format.c_str(), value.c_str());
+        value_f = String(buffer.get());
       }
     }
     html += value_f + String(F("</div>"));
@@ -0,0 +1,86 @@
+/**
+ *  Declaration of AutoConnectEventQueue class.
+ *  A bounded lock-free queue which conveys the event records from the
+ *  WiFi event callbacks to AutoConnect::handleRequest.
+ *  @file   AutoConnectEventQueue.h
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTEVENTQUEUE_H_
+#define _AUTOCONNECTEVENTQUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * Single-producer single-consumer ring buffer. Only one context may
+ * push, such as the WiFi event task of ESP32 or the SDK callback of
+ * ESP8266, and only one context may pop. Neither side blocks; a push
+ * to the full queue is dropped and counted. The indices are only
+ * loaded and stored, never read-modify-written, so that it does not
+ * depend on the atomic instructions that ESP8266 lacks.
+ * @param  T   Type of the event record, should be trivially copyable.
+ * @param  N   Capacity of the queue, must be a power of two.
+ */
+template<typename T, uint16_t N>
+class AutoConnectEventQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "AutoConnectEventQueue capacity must be a power of two");
+
+ public:
+  AutoConnectEventQueue() : _head(0), _tail(0), _drops(0), _highWater(0) {}
+  ~AutoConnectEventQueue() {}
+
+  /**
+   * Append an event record. Called only from the producer.
+   * @param  item  The event record.
+   * @return true  The record has been queued.
+   * @return false The queue is full, the record has been dropped.
+   */
+  bool  push(const T& item) {
+    uint32_t  tail = _tail.load(std::memory_order_relaxed);
+    uint32_t  depth = tail - _head.load(std::memory_order_acquire);
+    if (depth >= N) {
+      _drops.store(_drops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return false;
+    }
+    _ring[tail & (N - 1)] = item;
+    _tail.store(tail + 1, std::memory_order_release);
+    if (++depth > _highWater.load(std::memory_order_relaxed))
+      _highWater.store(depth, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * Take out the oldest event record. Called only from the consumer.
+   * @param  item  Receives the event record.
+   * @return true  A record has been taken out.
+   * @return false The queue is empty.
+   */
+  bool  pop(T& item) {
+    uint32_t  head = _head.load(std::memory_order_relaxed);
+    if (head == _tail.load(std::memory_order_acquire))
+      return false;
+    item = _ring[head & (N - 1)];
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  uint16_t  capacity(void) const { return N; }
+  uint32_t  drops(void) const { return _drops.load(std::memory_order_relaxed); }
+  bool      empty(void) const { return size() == 0; }
+  uint16_t  highWater(void) const { return static_cast<uint16_t>(_highWater.load(std::memory_order_relaxed)); }
+  uint16_t  size(void) const { return static_cast<uint16_t>(_tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire)); }
+
+ protected:
+  T _ring[N];                       /**< Event records */
+  std::atomic<uint32_t> _head;      /**< Next position to pop, owned by the consumer */
+  std::atomic<uint32_t> _tail;      /**< Next position to push, owned by the producer */
+  std::atomic<uint32_t> _drops;     /**< Records dropped by the full queue */
+  std::atomic<uint32_t> _highWater; /**< Maximum depth reached */
+};
+
+#endif // !_AUTOCONNECTEVENTQUEUE_H_
@@ -0,0 +1,158 @@
+/**
+ *  AutoConnectEvents class implementation.
+ *  Each event is written as the Server-Sent Events record to all the
+ *  subscribed clients at once.
+ *  @file   AutoConnectEvents.cpp
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#include "AutoConnectDefs.h"
+
+#ifdef AUTOCONNECT_USE_EVENTS
+
+#include "AutoConnectEvents.h"
+
+WiFiClient    AutoConnectEvents::_clients[AUTOCONNECT_EVENTS_CLIENTS];
+uint8_t       AutoConnectEvents::_count = 0;
+unsigned long AutoConnectEvents::_keepalive = 0;
+unsigned long AutoConnectEvents::_progressed = 0;
+
+/**
+ *  Take over the client of the current request as a subscriber. The
+ *  response header is written here, then the client stays connected
+ *  after the web server has released it.
+ *  @param  client  The client of the current request.
+ *  @return true  Subscribed.
+ *  @return false No room for the subscriber.
+ */
+bool AutoConnectEvents::subscribe(WiFiClient& client) {
+  static const char header[] PROGMEM =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n"
+    "retry: 3000\n\n";
+
+  _prune();
+  for (WiFiClient& subscriber : _clients) {
+    if (!subscriber.connected()) {
+      client.print(FPSTR(header));
+      subscriber = client;
+      _count++;
+      _keepalive = millis();
+      AC_DBG("Events subscribed %s, %d\n", client.remoteIP().toString().c_str(), (int)_count);
+      return true;
+    }
+  }
+  AC_DBG("Events subscribers full\n");
+  return false;
+}
+
+/**
+ *  Push an event to the subscribers.
+ *  @param  event Name of the event, in PROGMEM.
+ *  @param  data  Data of the event, a line without the line break.
+ */
+void AutoConnectEvents::push(PGM_P event, const char* data) {
+  if (!_count)
+    return;
+  char  record[160];
+  int   len = snprintf_P(record, sizeof(record), PSTR("event: %s\ndata: %s\n\n"), event, data);
+  if (len < 0 || static_cast<size_t>(len) >= sizeof(record)) {
+    AC_DBG("Event %s too long\n", event);
+    return;
+  }
+  _write(record, len);
+}
+
+/**
+ *  Push an event with the numeric data.
+ *  @param  event Name of the event, in PROGMEM.
+ *  @param  value Data of the event.
+ */
+void AutoConnectEvents::push(PGM_P event, const int32_t value) {
+  if (!_count)
+    return;
+  char  data[12];
+  snprintf_P(data, sizeof(data), PSTR("%ld"), static_cast<long>(value));
+  push(event, data);
+}
+
+/**
+ *  Push the progress of the transfer. The events are thinned out to
+ *  AUTOCONNECT_EVENTS_INTERVAL, except for the completion.
+ *  @param  event   Name of the event, in PROGMEM.
+ *  @param  amount  Transferred size.
+ *  @param  size    Total size, 0 if it is unknown.
+ */
+void AutoConnectEvents::progress(PGM_P event, const size_t amount, const size_t size) {
+  if (!_count)
+    return;
+  if (millis() - _progressed < AUTOCONNECT_EVENTS_INTERVAL && amount != size)
+    return;
+  _progressed = millis();
+  char  data[24];
+  snprintf_P(data, sizeof(data), PSTR(AC_EVENTS_PROGRESS ",%u:%u"), static_cast<unsigned int>(amount), static_cast<unsigned int>(size));
+  push(event, data);
+}
+
+/**
+ *  Push the end of the transfer.
+ *  @param  event   Name of the event, in PROGMEM.
+ */
+void AutoConnectEvents::end(PGM_P event) {
+  push(event, AC_EVENTS_END);
+}
+
+/**
+ *  Keep the event stream alive with the comment line while nothing is
+ *  pushed, and drop the clients which have left.
+ *  @return Number of the subscribers.
+ */
+uint8_t AutoConnectEvents::handle(void) {
+  if (_count && millis() - _keepalive >= AUTOCONNECT_EVENTS_KEEPALIVE) {
+    _write(":\n\n", 3);
+    _prune();
+  }
+  return _count;
+}
+
+/**
+ *  Write the record to each subscriber. The client which cannot accept
+ *  the whole record is dropped, a broken record cannot be recovered.
+ *  @param  text  The record.
+ *  @param  len   Length of the record.
+ */
+void AutoConnectEvents::_write(const char* text, const size_t len) {
+  bool  dropped = false;
+  for (WiFiClient& subscriber : _clients) {
+    if (subscriber.connected()) {
+      if (subscriber.write(reinterpret_cast<const uint8_t*>(text), len) != len) {
+        subscriber.stop();
+        dropped = true;
+      }
+    }
+  }
+  _keepalive = millis();
+  if (dropped)
+    _prune();
+}
+
+/**
+ *  Release the clients which have left, and count the subscribers.
+ */
+void AutoConnectEvents::_prune(void) {
+  _count = 0;
+  for (WiFiClient& subscriber : _clients) {
+    if (subscriber.connected())
+      _count++;
+    else
+      subscriber = WiFiClient();
+  }
+}
+
+#endif // !AUTOCONNECT_USE_EVENTS
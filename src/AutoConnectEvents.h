@@ -0,0 +1,65 @@
+/**
+ *  Declaration of AutoConnectEvents class.
+ *  Pushes the state changes to the browsers subscribed to the event
+ *  stream over one long-lived response of Server-Sent Events, instead
+ *  of the page reloads and the polling requests.
+ *  @file   AutoConnectEvents.h
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTEVENTS_H_
+#define _AUTOCONNECTEVENTS_H_
+
+#include "AutoConnectDefs.h"
+
+#ifdef AUTOCONNECT_USE_EVENTS
+// Pushes the events only with AUTOCONNECT_USE_EVENTS.
+#define AC_EVENTS(s) do {s;} while (0)
+#else
+#define AC_EVENTS(s) do {(void)0;} while (0)
+#endif // !AUTOCONNECT_USE_EVENTS
+
+#ifdef AUTOCONNECT_USE_EVENTS
+
+#include <Arduino.h>
+#if defined(ARDUINO_ARCH_ESP8266)
+#include <ESP8266WiFi.h>
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <WiFi.h>
+#endif
+
+// Data of the progress events, the same notation as the text endpoint
+// of AutoConnectUpdate.
+#define AC_EVENTS_PROGRESS  "#p"
+#define AC_EVENTS_END       "#e"
+
+/**
+ * The subscribed clients are held apart from the web server, which is
+ * released from the response after the subscription. An event is
+ * formatted once and written to each client, and the client which
+ * cannot accept it is dropped.
+ */
+class AutoConnectEvents {
+ public:
+  static bool     subscribe(WiFiClient& client);
+  static void     push(PGM_P event, const char* data);
+  static void     push(PGM_P event, const int32_t value);
+  static void     progress(PGM_P event, const size_t amount, const size_t size);
+  static void     end(PGM_P event);
+  static uint8_t  handle(void);
+  static uint8_t  subscribers(void) { return _count; }
+
+ protected:
+  static void     _write(const char* text, const size_t len);
+  static void     _prune(void);
+  static WiFiClient _clients[AUTOCONNECT_EVENTS_CLIENTS];  /**< Subscribers */
+  static uint8_t        _count;       /**< Number of the subscribers */
+  static unsigned long  _keepalive;   /**< millis() at the last write */
+  static unsigned long  _progressed;  /**< millis() at the last progress event */
+};
+
+#endif // !AUTOCONNECT_USE_EVENTS
+#endif // !_AUTOCONNECTEVENTS_H_
@@ -0,0 +1,271 @@
+/**
+ *  AutoConnectHeapTrace class implementation and the allocator wrappers.
+ *  The wrappers are bound by the linker option --wrap, which also works
+ *  with the host build so that the top allocators can be found without
+ *  the hardware.
+ *  @file   AutoConnectHeapTrace.cpp
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#include "AutoConnectDefs.h"
+
+#ifdef AC_HEAPTRACE
+
+#include "AutoConnectHeapTrace.h"
+#if !defined(ARDUINO_ARCH_ESP8266) && !defined(ARDUINO_ARCH_ESP32)
+#include <malloc.h>
+#endif
+
+bool  AutoConnectHeapTrace::_active = false;
+bool  AutoConnectHeapTrace::_suspended = false;
+char  AutoConnectHeapTrace::_route[AC_HEAPTRACE_ROUTELEN];
+AutoConnectHeapTrace::AC_HEAPCOUNT_t  AutoConnectHeapTrace::_request;
+int32_t AutoConnectHeapTrace::_usage;
+int32_t AutoConnectHeapTrace::_peak;
+size_t  AutoConnectHeapTrace::_freeStart;
+AutoConnectHeapTrace::AC_HEAPSCOPE_t* AutoConnectHeapTrace::_scope = nullptr;
+AutoConnectHeapTrace::AC_HEAPROUTE_t  AutoConnectHeapTrace::_routes[AC_HEAPTRACE_ROUTES];
+AutoConnectHeapTrace::AC_HEAPSCOPE_t  AutoConnectHeapTrace::_scopes[AC_HEAPTRACE_SCOPES];
+#ifdef ARDUINO_ARCH_ESP32
+TaskHandle_t  AutoConnectHeapTrace::_task = nullptr;
+#endif
+
+/**
+ *  Start tracing a request. The allocations until end are attributed
+ *  to the route given by the route function.
+ */
+void AutoConnectHeapTrace::begin(void) {
+  _route[0] = '\0';
+  memset(&_request, 0x00, sizeof(_request));
+  _usage = _peak = 0;
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+  _freeStart = ESP.getFreeHeap();
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+  _task = xTaskGetCurrentTaskHandle();
+#endif
+  _active = true;
+}
+
+/**
+ *  End tracing the request and accumulate it into the summary of the
+ *  route. A pass without any route and allocation is not a request.
+ */
+void AutoConnectHeapTrace::end(void) {
+  if (!_active)
+    return;
+  _active = false;
+  if (!_route[0]) {
+    if (!_request.allocs)
+      return;
+    strncpy(_route, "(unrouted)", sizeof(_route) - 1);
+  }
+
+  // Look for the route, the last entry is for the overflow.
+  AC_HEAPROUTE_t* entry = &_routes[AC_HEAPTRACE_ROUTES - 1];
+  for (uint8_t n = 0; n < AC_HEAPTRACE_ROUTES - 1; n++) {
+    if (!_routes[n].name[0]) {
+      strncpy(_routes[n].name, _route, sizeof(_routes[n].name) - 1);
+      entry = &_routes[n];
+      break;
+    }
+    if (!strcmp(_routes[n].name, _route)) {
+      entry = &_routes[n];
+      break;
+    }
+  }
+  if (!entry->name[0])
+    strncpy(entry->name, "(other)", sizeof(entry->name) - 1);
+  entry->requests++;
+  entry->count.allocs += _request.allocs;
+  entry->count.frees += _request.frees;
+  entry->count.bytes += _request.bytes;
+  if (_peak > 0 && static_cast<uint32_t>(_peak) > entry->peak)
+    entry->peak = _peak;
+  _suspended = true;
+  AC_DBG("Heap %s:%u allocs,%u frees,%u bytes,peak %d\n", _route, _request.allocs, _request.frees, _request.bytes, _peak);
+  _suspended = false;
+}
+
+/**
+ *  Set the route of the request in progress. The first one wins.
+ *  @param  name  URI of the route.
+ */
+void AutoConnectHeapTrace::route(const char* name) {
+  if (_active && !_route[0]) {
+    strncpy(_route, name, sizeof(_route) - 1);
+    _route[sizeof(_route) - 1] = '\0';
+  }
+}
+
+/**
+ *  Reset the summaries.
+ */
+void AutoConnectHeapTrace::clear(void) {
+  memset(_routes, 0x00, sizeof(_routes));
+  memset(_scopes, 0x00, sizeof(_scopes));
+}
+
+/**
+ *  Print the summaries of the routes and the scopes. The scopes are
+ *  listed in descending order of the allocated bytes.
+ *  @param  out   Output destination such as Serial.
+ */
+void AutoConnectHeapTrace::dump(Print& out) {
+  _suspended = true;
+  out.println(F("route,requests,allocs,frees,bytes,peak"));
+  for (uint8_t n = 0; n < AC_HEAPTRACE_ROUTES && _routes[n].name[0]; n++) {
+    const AC_HEAPROUTE_t& r = _routes[n];
+    out.printf_P(PSTR("%s,%u,%u,%u,%u,%u\n"), r.name, r.requests, r.count.allocs, r.count.frees, r.count.bytes, r.peak);
+  }
+  out.println(F("scope,allocs,frees,bytes"));
+  bool  listed[AC_HEAPTRACE_SCOPES] = { false };
+  for (uint8_t i = 0; i < AC_HEAPTRACE_SCOPES; i++) {
+    int8_t  top = -1;
+    for (uint8_t n = 0; n < AC_HEAPTRACE_SCOPES && _scopes[n].name; n++) {
+      if (!listed[n] && (top < 0 || _scopes[n].count.bytes > _scopes[top].count.bytes))
+        top = n;
+    }
+    if (top < 0)
+      break;
+    listed[top] = true;
+    const AC_HEAPSCOPE_t& s = _scopes[top];
+    out.printf_P(PSTR("%s,%u,%u,%u\n"), s.name, s.count.allocs, s.count.frees, s.count.bytes);
+  }
+  _suspended = false;
+}
+
+/**
+ *  Render the summaries in the Prometheus text format to be appended
+ *  to the metrics.
+ */
+String AutoConnectHeapTrace::toPrometheus(void) {
+  static const char* const  routeItems[] = { "allocs", "frees", "bytes" };
+  String  out;
+  out.reserve(512);
+  for (uint8_t i = 0; i < 3; i++) {
+    out += String(F("# TYPE autoconnect_heap_")) + routeItems[i] + String(F("_total counter\n"));
+    for (uint8_t n = 0; n < AC_HEAPTRACE_ROUTES && _routes[n].name[0]; n++) {
+      const AC_HEAPCOUNT_t& c = _routes[n].count;
+      uint32_t  v = i == 0 ? c.allocs : (i == 1 ? c.frees : c.bytes);
+      out += String(F("autoconnect_heap_")) + routeItems[i] + String(F("_total{route=\"")) + _routes[n].name + String(F("\"} ")) + String(v) + '\n';
+    }
+    for (uint8_t n = 0; n < AC_HEAPTRACE_SCOPES && _scopes[n].name; n++) {
+      const AC_HEAPCOUNT_t& c = _scopes[n].count;
+      uint32_t  v = i == 0 ? c.allocs : (i == 1 ? c.frees : c.bytes);
+      out += String(F("autoconnect_heap_")) + routeItems[i] + String(F("_total{scope=\"")) + _scopes[n].name + String(F("\"} ")) + String(v) + '\n';
+    }
+  }
+  out += F("# TYPE autoconnect_heap_request_peak_bytes gauge\n");
+  for (uint8_t n = 0; n < AC_HEAPTRACE_ROUTES && _routes[n].name[0]; n++)
+    out += String(F("autoconnect_heap_request_peak_bytes{route=\"")) + _routes[n].name + String(F("\"} ")) + String(_routes[n].peak) + '\n';
+  return out;
+}
+
+/**
+ *  Count an allocation into the request and the current scope.
+ *  @param  ptr   Allocated block, nullptr if failed.
+ *  @param  size  Requested size.
+ */
+void AutoConnectHeapTrace::allocated(void* ptr, const size_t size) {
+  if (!ptr || !_isTracing())
+    return;
+  _request.allocs++;
+  _request.bytes += size;
+  if (_scope) {
+    _scope->count.allocs++;
+    _scope->count.bytes += size;
+  }
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+  _usage = static_cast<int32_t>(_freeStart) - static_cast<int32_t>(ESP.getFreeHeap());
+#else
+  _usage += malloc_usable_size(ptr);
+#endif
+  if (_usage > _peak)
+    _peak = _usage;
+}
+
+/**
+ *  Count a free into the request and the current scope.
+ *  @param  ptr   Block to be freed.
+ */
+void AutoConnectHeapTrace::freed(void* ptr) {
+  if (!ptr || !_isTracing())
+    return;
+  _request.frees++;
+  if (_scope)
+    _scope->count.frees++;
+#if !defined(ARDUINO_ARCH_ESP8266) && !defined(ARDUINO_ARCH_ESP32)
+  _usage -= malloc_usable_size(ptr);
+#endif
+}
+
+/**
+ *  Look for the scope, or register it. The name is compared by the
+ *  pointer first since it is a literal.
+ *  @param  name  Name of the scope.
+ *  @return The scope, nullptr if the table is full.
+ */
+AutoConnectHeapTrace::AC_HEAPSCOPE_t* AutoConnectHeapTrace::_find(const char* name) {
+  for (uint8_t n = 0; n < AC_HEAPTRACE_SCOPES; n++) {
+    if (!_scopes[n].name) {
+      _scopes[n].name = name;
+      return &_scopes[n];
+    }
+    if (_scopes[n].name == name || !strcmp(_scopes[n].name, name))
+      return &_scopes[n];
+  }
+  return nullptr;
+}
+
+/**
+ *  The allocation is counted only while a request is traced by the
+ *  task which began it.
+ */
+bool AutoConnectHeapTrace::_isTracing(void) {
+#ifdef ARDUINO_ARCH_ESP32
+  if (_active && xTaskGetCurrentTaskHandle() != _task)
+    return false;
+#endif
+  return _active && !_suspended;
+}
+
+/**
+ *  Allocator wrappers bound by -Wl,--wrap=malloc,--wrap=free,
+ *  --wrap=realloc,--wrap=calloc.
+ */
+extern "C" {
+void* __real_malloc(size_t size);
+void  __real_free(void* ptr);
+void* __real_realloc(void* ptr, size_t size);
+void* __real_calloc(size_t n, size_t size);
+
+void* __wrap_malloc(size_t size) {
+  void* ptr = __real_malloc(size);
+  AutoConnectHeapTrace::allocated(ptr, size);
+  return ptr;
+}
+
+void __wrap_free(void* ptr) {
+  AutoConnectHeapTrace::freed(ptr);
+  __real_free(ptr);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+  AutoConnectHeapTrace::freed(ptr);
+  void* reallocated = __real_realloc(ptr, size);
+  AutoConnectHeapTrace::allocated(reallocated, size);
+  return reallocated;
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+  void* ptr = __real_calloc(n, size);
+  AutoConnectHeapTrace::allocated(ptr, n * size);
+  return ptr;
+}
+}
+
+#endif // !AC_HEAPTRACE
@@ -0,0 +1,114 @@
+/**
+ *  Declaration of AutoConnectHeapTrace class.
+ *  A debugging instrument that counts the heap allocations per HTTP
+ *  request and attributes them to the route and the scope such as a
+ *  token handler.
+ *  @file   AutoConnectHeapTrace.h
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTHEAPTRACE_H_
+#define _AUTOCONNECTHEAPTRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "AutoConnectDefs.h"
+
+#ifdef AC_HEAPTRACE
+#define AC_HEAPTRACE_BEGIN()      AutoConnectHeapTrace::begin()
+#define AC_HEAPTRACE_END()        AutoConnectHeapTrace::end()
+#define AC_HEAPTRACE_ROUTE(r)     AutoConnectHeapTrace::route(r)
+#define AC_HEAPTRACE_SCOPE(s)     AutoConnectHeapTrace::Scope _acHeapScope(s)
+#else
+#define AC_HEAPTRACE_BEGIN()      do {(void)0;} while (0)
+#define AC_HEAPTRACE_END()        do {(void)0;} while (0)
+#define AC_HEAPTRACE_ROUTE(r)     do {(void)0;} while (0)
+#define AC_HEAPTRACE_SCOPE(s)     do {(void)0;} while (0)
+#endif // !AC_HEAPTRACE
+
+#ifdef AC_HEAPTRACE
+
+#include <Arduino.h>
+
+// Number of the routes to be summarized
+#ifndef AC_HEAPTRACE_ROUTES
+#define AC_HEAPTRACE_ROUTES   12
+#endif // !AC_HEAPTRACE_ROUTES
+
+// Number of the scopes to be summarized
+#ifndef AC_HEAPTRACE_SCOPES
+#define AC_HEAPTRACE_SCOPES   16
+#endif // !AC_HEAPTRACE_SCOPES
+
+// Maximum length of the route name
+#define AC_HEAPTRACE_ROUTELEN 32
+
+class AutoConnectHeapTrace {
+ public:
+  /** Heap activities */
+  typedef struct {
+    uint32_t  allocs;       /**< Number of the allocations */
+    uint32_t  frees;        /**< Number of the frees */
+    uint32_t  bytes;        /**< Total bytes allocated */
+  } AC_HEAPCOUNT_t;
+
+  /** Summary of a route */
+  typedef struct {
+    char      name[AC_HEAPTRACE_ROUTELEN];  /**< URI of the route */
+    uint32_t  requests;     /**< Number of the requests */
+    AC_HEAPCOUNT_t  count;  /**< Heap activities of the route */
+    uint32_t  peak;         /**< Maximum heap usage in a request */
+  } AC_HEAPROUTE_t;
+
+  /** Summary of a scope */
+  typedef struct {
+    const char* name;       /**< Name of the scope, a literal */
+    AC_HEAPCOUNT_t  count;  /**< Heap activities in the scope */
+  } AC_HEAPSCOPE_t;
+
+  /**
+   * Attributes the allocations during its lifetime to the named scope.
+   * The scopes can be nested, the innermost one takes the allocations.
+   */
+  class Scope {
+   public:
+    explicit Scope(const char* name) : _prev(_scope) { _scope = _find(name); }
+    ~Scope() { _scope = _prev; }
+   private:
+    AC_HEAPSCOPE_t* _prev;
+  };
+
+  static void begin(void);
+  static void end(void);
+  static void route(const char* name);
+  static void clear(void);
+  static void dump(Print& out);
+  static String toPrometheus(void);
+
+  /** Called from the allocator wrappers */
+  static void allocated(void* ptr, const size_t size);
+  static void freed(void* ptr);
+
+ protected:
+  static AC_HEAPSCOPE_t*  _find(const char* name);
+  static bool   _isTracing(void);
+  static bool   _active;            /**< A request is being traced */
+  static bool   _suspended;         /**< Not to trace the tracer itself */
+  static char   _route[AC_HEAPTRACE_ROUTELEN];  /**< Route of the request */
+  static AC_HEAPCOUNT_t _request;   /**< Heap activities of the request */
+  static int32_t  _usage;           /**< Heap usage since the beginning of the request */
+  static int32_t  _peak;            /**< Peak of the heap usage in the request */
+  static size_t _freeStart;         /**< Free heap at the beginning of the request */
+  static AC_HEAPSCOPE_t*  _scope;   /**< Current scope */
+  static AC_HEAPROUTE_t _routes[AC_HEAPTRACE_ROUTES];
+  static AC_HEAPSCOPE_t _scopes[AC_HEAPTRACE_SCOPES];
+#ifdef ARDUINO_ARCH_ESP32
+  static TaskHandle_t _task;        /**< Task which began the request */
+#endif
+};
+
+#endif // !AC_HEAPTRACE
+#endif // !_AUTOCONNECTHEAPTRACE_H_
@@ -0,0 +1,324 @@
+/**
+ *  AutoConnectMetrics class implementation.
+ *  The recording is allocation-free, and only the rendering of the
+ *  endpoint builds the String.
+ *  @file   AutoConnectMetrics.cpp
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#include "AutoConnectDefs.h"
+
+#ifdef AUTOCONNECT_USE_METRICS
+
+#include "AutoConnectMetrics.h"
+
+/**
+ *  Route names as the label, in the order of AC_METRICSROUTE_t.
+ */
+const char* const AutoConnectMetrics::_routeNames[] = {
+  "root", "config", "connect", "result", "open", "disc", "reset", "success", "fail", "aux", "probe", "notfound", "metrics"
+};
+
+/**
+ *  Phase names as the label, in the order of AC_BOOTPHASE_t.
+ */
+const char* const AutoConnectMetrics::_phaseNames[] = {
+  "prepare", "credential", "scan", "connect", "softap", "webserver", "dns"
+};
+
+/**
+ *  Flash wear labels, in the order of AC_WEARSUBSYS_t and AC_WEARREGION_t.
+ */
+const char* const AutoConnectMetrics::_subsysNames[] = {
+  "credential", "element", "upload", "ota"
+};
+const char* const AutoConnectMetrics::_regionNames[] = {
+  "eeprom", "nvs", "fs", "app"
+};
+
+AutoConnectMetrics::AutoConnectMetrics() : _booted(false) {
+  clear();
+}
+
+/**
+ *  Identify the route of the AutoConnect page. Any other page handled
+ *  by AutoConnect is an AutoConnectAux.
+ *  @param  uri   Requested URI.
+ *  @return The route.
+ */
+AC_METRICSROUTE_t AutoConnectMetrics::classify(const String& uri) {
+  static const char* const uris[] = {
+    AUTOCONNECT_URI, AUTOCONNECT_URI_CONFIG, AUTOCONNECT_URI_CONNECT, AUTOCONNECT_URI_RESULT, AUTOCONNECT_URI_OPEN,
+    AUTOCONNECT_URI_DISCON, AUTOCONNECT_URI_RESET, AUTOCONNECT_URI_SUCCESS, AUTOCONNECT_URI_FAIL
+  };
+  for (uint8_t n = 0; n < sizeof(uris) / sizeof(uris[0]); n++) {
+    if (uri == uris[n])
+      return static_cast<AC_METRICSROUTE_t>(n);
+  }
+  return AC_METRICSROUTE_AUX;
+}
+
+/**
+ *  Reset all metrics.
+ */
+void AutoConnectMetrics::clear(void) {
+  memset(_latency, 0x00, sizeof(_latency));
+  memset(_bytes, 0x00, sizeof(_bytes));
+#ifdef AUTOCONNECT_USE_ARENA
+  memset(_arenaPeak, 0x00, sizeof(_arenaPeak));
+#endif
+  memset(&_timeToIP, 0x00, sizeof(_timeToIP));
+  _dnsQueries = 0;
+  _scans = _scanTime = _scanMax = 0;
+  _scanStart = 0;
+  _attempts = 0;
+  _commits = 0;
+  _heapLow = _blockLow = UINT32_MAX;
+}
+
+/**
+ *  Record a request.
+ *  @param  route   Route of the request.
+ *  @param  elapsed Time taken to respond [ms].
+ *  @param  bytes   Size of the response, 0 if unknown.
+ */
+void AutoConnectMetrics::request(const AC_METRICSROUTE_t route, const uint32_t elapsed, const uint32_t bytes) {
+  if (route >= AC_METRICSROUTE_NONE)
+    return;
+  _observe(_latency[route], elapsed);
+  _bytes[route] += bytes;
+}
+
+#ifdef AUTOCONNECT_USE_ARENA
+/**
+ *  Record the arena usage of a request, and keep the largest by the
+ *  route to size AUTOCONNECT_ARENA_SIZE.
+ *  @param  route   Route of the request.
+ *  @param  peak    Peak usage of the arena in the request [bytes].
+ */
+void AutoConnectMetrics::arena(const AC_METRICSROUTE_t route, const size_t peak) {
+  if (route < AC_METRICSROUTE_NONE && peak > _arenaPeak[route])
+    _arenaPeak[route] = peak;
+}
+#endif // !AUTOCONNECT_USE_ARENA
+
+/**
+ *  Record the end of the scan started by beginScan. It is called at the
+ *  completion of both the synchronous and asynchronous scans.
+ */
+void AutoConnectMetrics::endScan(void) {
+  if (!_scanStart)
+    return;
+  uint32_t  elapsed = millis() - _scanStart;
+  _scanStart = 0;
+  _scanTime += elapsed;
+  if (elapsed > _scanMax)
+    _scanMax = elapsed;
+}
+
+/**
+ *  Record a connection attempt.
+ *  @param  established The connection has been established.
+ *  @param  elapsed     Time taken until the IP acquired [ms].
+ */
+void AutoConnectMetrics::connect(const bool established, const uint32_t elapsed) {
+  _attempts++;
+  if (established)
+    _observe(_timeToIP, elapsed);
+}
+
+/**
+ *  Update the low-water marks of the heap.
+ */
+void AutoConnectMetrics::sampleHeap(void) {
+  uint32_t  heap = ESP.getFreeHeap();
+#if defined(ARDUINO_ARCH_ESP8266)
+  uint32_t  block = ESP.getMaxFreeBlockSize();
+#elif defined(ARDUINO_ARCH_ESP32)
+  uint32_t  block = ESP.getMaxAllocHeap();
+#endif
+  if (heap < _heapLow)
+    _heapLow = heap;
+  if (block < _blockLow)
+    _blockLow = block;
+}
+
+/**
+ *  Count the value into the bucket whose upper bound is the smallest
+ *  power of two not less than it.
+ */
+void AutoConnectMetrics::_observe(AC_HISTOGRAM_t& histogram, const uint32_t value) {
+  uint8_t n = value <= 1 ? 0 : 32 - __builtin_clz(value - 1);
+  if (n >= AC_METRICS_BUCKETS)
+    n = AC_METRICS_BUCKETS - 1;
+  histogram.bucket[n]++;
+  histogram.count++;
+  histogram.sum += value;
+}
+
+/**
+ *  Render the metrics in the Prometheus text exposition format. The
+ *  routes that have never been requested are omitted.
+ */
+String AutoConnectMetrics::toPrometheus(void) const {
+  String  out;
+  out.reserve(1024);
+  out += F("# TYPE autoconnect_http_requests_total counter\n");
+  for (uint8_t r = 0; r < AC_METRICSROUTE_NONE; r++) {
+    if (_latency[r].count)
+      out += String(F("autoconnect_http_requests_total{route=\"")) + _routeNames[r] + String(F("\"} ")) + String(_latency[r].count) + '\n';
+  }
+  out += F("# TYPE autoconnect_http_response_bytes_total counter\n");
+  for (uint8_t r = 0; r < AC_METRICSROUTE_NONE; r++) {
+    if (_latency[r].count)
+      out += String(F("autoconnect_http_response_bytes_total{route=\"")) + _routeNames[r] + String(F("\"} ")) + String(_bytes[r]) + '\n';
+  }
+  out += F("# TYPE autoconnect_http_request_duration_ms histogram\n");
+  for (uint8_t r = 0; r < AC_METRICSROUTE_NONE; r++) {
+    if (_latency[r].count)
+      _promHistogram(out, "autoconnect_http_request_duration_ms", _routeNames[r], _latency[r]);
+  }
+  out += String(F("# TYPE autoconnect_dns_queries_total counter\nautoconnect_dns_queries_total ")) + String(_dnsQueries) + '\n';
+  out += String(F("# TYPE autoconnect_wifi_scans_total counter\nautoconnect_wifi_scans_total ")) + String(_scans) + '\n';
+  out += String(F("# TYPE autoconnect_wifi_scan_duration_ms_total counter\nautoconnect_wifi_scan_duration_ms_total ")) + String(_scanTime) + '\n';
+  out += String(F("# TYPE autoconnect_wifi_scan_duration_ms_max gauge\nautoconnect_wifi_scan_duration_ms_max ")) + String(_scanMax) + '\n';
+  out += String(F("# TYPE autoconnect_wifi_connect_attempts_total counter\nautoconnect_wifi_connect_attempts_total ")) + String(_attempts) + '\n';
+  out += F("# TYPE autoconnect_wifi_time_to_ip_ms histogram\n");
+  _promHistogram(out, "autoconnect_wifi_time_to_ip_ms", nullptr, _timeToIP);
+  out += String(F("# TYPE autoconnect_credential_commits_total counter\nautoconnect_credential_commits_total ")) + String(_commits) + '\n';
+  out += String(F("# TYPE autoconnect_heap_free_bytes gauge\nautoconnect_heap_free_bytes ")) + String(ESP.getFreeHeap()) + '\n';
+  if (_heapLow != UINT32_MAX) {
+    out += String(F("# TYPE autoconnect_heap_free_low_bytes gauge\nautoconnect_heap_free_low_bytes ")) + String(_heapLow) + '\n';
+    out += String(F("# TYPE autoconnect_heap_max_block_low_bytes gauge\nautoconnect_heap_max_block_low_bytes ")) + String(_blockLow) + '\n';
+  }
+  if (_booted) {
+    out += F("# TYPE autoconnect_boot_phase_us gauge\n");
+    for (uint8_t n = 0; n < AC_BOOTPHASE_COUNT; n++)
+      out += String(F("autoconnect_boot_phase_us{phase=\"")) + _phaseNames[n] + String(F("\"} ")) + String(_boot.phase[n]) + '\n';
+    out += String(F("# TYPE autoconnect_boot_time_to_connected_us gauge\nautoconnect_boot_time_to_connected_us ")) + String(_boot.toConnected) + '\n';
+    out += String(F("# TYPE autoconnect_boot_time_to_portal_us gauge\nautoconnect_boot_time_to_portal_us ")) + String(_boot.toPortal) + '\n';
+  }
+#ifdef AUTOCONNECT_USE_ARENA
+  out += String(F("# TYPE autoconnect_arena_size_bytes gauge\nautoconnect_arena_size_bytes ")) + String(AUTOCONNECT_ARENA_SIZE) + '\n';
+  out += F("# TYPE autoconnect_arena_peak_bytes gauge\n");
+  for (uint8_t r = 0; r < AC_METRICSROUTE_NONE; r++) {
+    if (_latency[r].count)
+      out += String(F("autoconnect_arena_peak_bytes{route=\"")) + _routeNames[r] + String(F("\"} ")) + String(_arenaPeak[r]) + '\n';
+  }
+  out += String(F("# TYPE autoconnect_arena_overflow_total counter\nautoconnect_arena_overflow_total ")) + String(AutoConnectArena::overflow()) + '\n';
+#endif // !AUTOCONNECT_USE_ARENA
+  static const char* const  wearItems[] = { "commits", "write_bytes", "erase_bytes" };
+  for (uint8_t i = 0; i < 3; i++) {
+    out += String(F("# TYPE autoconnect_flash_")) + wearItems[i] + String(F("_total counter\n"));
+    for (uint8_t n = 0; n < AC_WEARSUBSYS_COUNT; n++) {
+      const AutoConnectWearCount_t& c = AutoConnectWear::count(static_cast<AC_WEARSUBSYS_t>(n));
+      uint32_t  v = i == 0 ? c.commits : (i == 1 ? c.bytes : c.erase);
+      out += String(F("autoconnect_flash_")) + wearItems[i] + String(F("_total{subsystem=\"")) + _subsysNames[n] + String(F("\"} ")) + String(v) + '\n';
+    }
+    for (uint8_t n = 0; n < AC_WEARREGION_COUNT; n++) {
+      const AutoConnectWearCount_t& c = AutoConnectWear::count(static_cast<AC_WEARREGION_t>(n));
+      uint32_t  v = i == 0 ? c.commits : (i == 1 ? c.bytes : c.erase);
+      out += String(F("autoconnect_flash_")) + wearItems[i] + String(F("_total{region=\"")) + _regionNames[n] + String(F("\"} ")) + String(v) + '\n';
+    }
+  }
+  out += F("# TYPE autoconnect_flash_limited_total counter\n");
+  for (uint8_t n = 0; n < AC_WEARSUBSYS_COUNT; n++)
+    out += String(F("autoconnect_flash_limited_total{subsystem=\"")) + _subsysNames[n] + String(F("\"} ")) + String(AutoConnectWear::limited(static_cast<AC_WEARSUBSYS_t>(n))) + '\n';
+  return out;
+}
+
+/**
+ *  Render the metrics in JSON. The histograms hold the non-cumulative
+ *  counts of the buckets whose upper bounds are listed in "le".
+ */
+String AutoConnectMetrics::toJson(void) const {
+  String  out;
+  out.reserve(1024);
+  out += F("{\"le\":[");
+  for (uint8_t n = 0; n < AC_METRICS_BUCKETS - 1; n++) {
+    if (n)
+      out += ',';
+    out += String(1UL << n);
+  }
+  out += F("],\"routes\":{");
+  bool  first = true;
+  for (uint8_t r = 0; r < AC_METRICSROUTE_NONE; r++) {
+    if (!_latency[r].count)
+      continue;
+    if (!first)
+      out += ',';
+    first = false;
+    out += String('"') + _routeNames[r] + String(F("\":{\"bytes\":")) + String(_bytes[r]) + ',';
+#ifdef AUTOCONNECT_USE_ARENA
+    out += String(F("\"arena\":")) + String(_arenaPeak[r]) + ',';
+#endif
+    _jsonHistogram(out, _latency[r]);
+    out += '}';
+  }
+  out += String(F("},\"dns\":{\"queries\":")) + String(_dnsQueries);
+  out += String(F("},\"scan\":{\"count\":")) + String(_scans) + String(F(",\"duration\":")) + String(_scanTime) + String(F(",\"max\":")) + String(_scanMax);
+  out += String(F("},\"connect\":{\"attempts\":")) + String(_attempts) + ',';
+  _jsonHistogram(out, _timeToIP);
+  out += String(F("},\"commits\":")) + String(_commits);
+  out += String(F(",\"heap\":{\"free\":")) + String(ESP.getFreeHeap());
+  if (_heapLow != UINT32_MAX)
+    out += String(F(",\"freeLow\":")) + String(_heapLow) + String(F(",\"maxBlockLow\":")) + String(_blockLow);
+  out += '}';
+  if (_booted) {
+    out += String(F(",\"boot\":{\"async\":")) + String(_boot.async ? F("true") : F("false")) + String(F(",\"phases\":{"));
+    for (uint8_t n = 0; n < AC_BOOTPHASE_COUNT; n++) {
+      if (n)
+        out += ',';
+      out += String('"') + _phaseNames[n] + String(F("\":")) + String(_boot.phase[n]);
+    }
+    out += String(F("},\"toConnected\":")) + String(_boot.toConnected) + String(F(",\"toPortal\":")) + String(_boot.toPortal) + '}';
+  }
+#ifdef AUTOCONNECT_USE_ARENA
+  out += String(F(",\"arena\":{\"size\":")) + String(AUTOCONNECT_ARENA_SIZE) + String(F(",\"overflow\":")) + String(AutoConnectArena::overflow()) + '}';
+#endif
+  out += F(",\"wear\":{");
+  for (uint8_t n = 0; n < AC_WEARSUBSYS_COUNT; n++) {
+    const AutoConnectWearCount_t& c = AutoConnectWear::count(static_cast<AC_WEARSUBSYS_t>(n));
+    if (n)
+      out += ',';
+    out += String('"') + _subsysNames[n] + String(F("\":{\"commits\":")) + String(c.commits) + String(F(",\"bytes\":")) + String(c.bytes) + String(F(",\"erase\":")) + String(c.erase) + String(F(",\"limited\":")) + String(AutoConnectWear::limited(static_cast<AC_WEARSUBSYS_t>(n))) + '}';
+  }
+  out += F("}}");
+  return out;
+}
+
+/**
+ *  Append a histogram in the Prometheus text format with the cumulative
+ *  bucket counts.
+ */
+void AutoConnectMetrics::_promHistogram(String& out, const char* name, const char* label, const AC_HISTOGRAM_t& histogram) {
+  String  route = label ? String(F("route=\"")) + label + String(F("\",")) : String();
+  uint32_t  cumulative = 0;
+  for (uint8_t n = 0; n < AC_METRICS_BUCKETS; n++) {
+    cumulative += histogram.bucket[n];
+    out += String(name) + String(F("_bucket{")) + route + String(F("le=\""));
+    out += n < AC_METRICS_BUCKETS - 1 ? String(1UL << n) : String(F("+Inf"));
+    out += String(F("\"} ")) + String(cumulative) + '\n';
+  }
+  String  suffix = label ? String(F("{route=\"")) + label + String(F("\"} ")) : String(' ');
+  out += String(name) + String(F("_sum")) + suffix + String(histogram.sum) + '\n';
+  out += String(name) + String(F("_count")) + suffix + String(histogram.count) + '\n';
+}
+
+/**
+ *  Append the members of a histogram in JSON.
+ */
+void AutoConnectMetrics::_jsonHistogram(String& out, const AC_HISTOGRAM_t& histogram) {
+  out += String(F("\"count\":")) + String(histogram.count) + String(F(",\"sum\":")) + String(histogram.sum) + String(F(",\"buckets\":["));
+  for (uint8_t n = 0; n < AC_METRICS_BUCKETS; n++) {
+    if (n)
+      out += ',';
+    out += String(histogram.bucket[n]);
+  }
+  out += ']';
+}
+
+#endif // !AUTOCONNECT_USE_METRICS
@@ -0,0 +1,109 @@
+/**
+ *  Declaration of AutoConnectMetrics class.
+ *  Records the counters and the latency histograms of the portal, and
+ *  renders them in the Prometheus text format or JSON.
+ *  @file   AutoConnectMetrics.h
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTMETRICS_H_
+#define _AUTOCONNECTMETRICS_H_
+
+#include <Arduino.h>
+#include "AutoConnectDefs.h"
+#include "AutoConnectTypes.h"
+#include "AutoConnectStats.h"
+#include "AutoConnectArena.h"
+
+#ifdef AUTOCONNECT_USE_METRICS
+// Records the metrics only with AUTOCONNECT_USE_METRICS.
+#define AC_METRICS(s) do {s;} while (0)
+#else
+#define AC_METRICS(s) do {(void)0;} while (0)
+#endif // !AUTOCONNECT_USE_METRICS
+
+#ifdef AUTOCONNECT_USE_METRICS
+
+/**
+ * Number of the buckets of the latency histogram. The upper bound of
+ * the bucket n is 2^n [ms], and the last one is +Inf.
+ */
+#define AC_METRICS_BUCKETS  15
+
+/** Routes of the requests distinguished by the metrics */
+typedef enum {
+  AC_METRICSROUTE_ROOT,
+  AC_METRICSROUTE_CONFIG,
+  AC_METRICSROUTE_CONNECT,
+  AC_METRICSROUTE_RESULT,
+  AC_METRICSROUTE_OPEN,
+  AC_METRICSROUTE_DISCON,
+  AC_METRICSROUTE_RESET,
+  AC_METRICSROUTE_SUCCESS,
+  AC_METRICSROUTE_FAIL,
+  AC_METRICSROUTE_AUX,
+  AC_METRICSROUTE_PROBE,
+  AC_METRICSROUTE_NOTFOUND,
+  AC_METRICSROUTE_METRICS,
+  AC_METRICSROUTE_NONE
+} AC_METRICSROUTE_t;
+
+/** Latency histogram with the log-scale buckets */
+typedef struct {
+  uint32_t  bucket[AC_METRICS_BUCKETS]; /**< Non-cumulative counts */
+  uint32_t  count;                      /**< Number of the observations */
+  uint32_t  sum;                        /**< Sum of the observations [ms] */
+} AC_HISTOGRAM_t;
+
+class AutoConnectMetrics {
+ public:
+  AutoConnectMetrics();
+  ~AutoConnectMetrics() {}
+  static AC_METRICSROUTE_t  classify(const String& uri);
+  void  clear(void);
+  void  request(const AC_METRICSROUTE_t route, const uint32_t elapsed, const uint32_t bytes);
+  void  dns(const uint32_t queries) { _dnsQueries += queries; }
+  void  beginScan(void) { _scanStart = millis(); _scans++; }
+  void  endScan(void);
+  void  connect(const bool established, const uint32_t elapsed);
+  void  commit(void) { _commits++; }
+  void  boot(const AC_BOOTPROFILE_t& profile) { _boot = profile; _booted = true; }
+  void  sampleHeap(void);
+#ifdef AUTOCONNECT_USE_ARENA
+  void  arena(const AC_METRICSROUTE_t route, const size_t peak);
+#endif // !AUTOCONNECT_USE_ARENA
+  String  toJson(void) const;
+  String  toPrometheus(void) const;
+
+ protected:
+  static void _observe(AC_HISTOGRAM_t& histogram, const uint32_t value);
+  static void _promHistogram(String& out, const char* name, const char* label, const AC_HISTOGRAM_t& histogram);
+  static void _jsonHistogram(String& out, const AC_HISTOGRAM_t& histogram);
+  AC_HISTOGRAM_t  _latency[AC_METRICSROUTE_NONE]; /**< Request latency by the route */
+  uint32_t  _bytes[AC_METRICSROUTE_NONE];         /**< Bytes sent by the route */
+  uint32_t  _dnsQueries;      /**< DNS queries processed */
+  uint32_t  _scans;           /**< Number of the scans started */
+  uint32_t  _scanTime;        /**< Total duration of the scans [ms] */
+  uint32_t  _scanMax;         /**< Longest scan [ms] */
+  unsigned long _scanStart;   /**< Start of the scan in progress, 0 if none */
+  uint32_t  _attempts;        /**< Connection attempts */
+  AC_HISTOGRAM_t  _timeToIP;  /**< Time-to-IP of the established connections */
+  uint32_t  _commits;         /**< Credentials saved */
+  uint32_t  _heapLow;         /**< Low-water of the free heap */
+  uint32_t  _blockLow;        /**< Low-water of the largest free block */
+  AC_BOOTPROFILE_t  _boot;    /**< Time profile of the latest begin */
+  bool      _booted;          /**< _boot is available */
+#ifdef AUTOCONNECT_USE_ARENA
+  uint32_t  _arenaPeak[AC_METRICSROUTE_NONE];     /**< Arena peak by the route */
+#endif // !AUTOCONNECT_USE_ARENA
+  static const char* const  _routeNames[];
+  static const char* const  _phaseNames[];
+  static const char* const  _subsysNames[];
+  static const char* const  _regionNames[];
+};
+
+#endif // !AUTOCONNECT_USE_METRICS
+#endif // !_AUTOCONNECTMETRICS_H_
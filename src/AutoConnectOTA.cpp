@@ -254,11 +254,16 @@ size_t AutoConnectOTA::_write(const uint8_t *buf, const size_t size) {
       wsz = Update.write(const_cast<uint8_t*>(buf), size);
       if (wsz != size)
         _setError();
+      // The application partition is erased as it is written.
+      AutoConnectWear::write(AC_WEARSUBSYS_OTA, AC_WEARREGION_APP, wsz, wsz);
+      AC_EVENTS(AutoConnectEvents::progress(PSTR("ota"), Update.progress(), 0));
     }
     else {
       wsz = _file.write(buf, size);
       if (wsz != size)
         _setError("Incomplete writing");
+      AutoConnectWear::write(AC_WEARSUBSYS_OTA, AC_WEARREGION_FS, wsz);
+      AC_EVENTS(AutoConnectEvents::progress(PSTR("ota"), _file.position(), 0));
     }
   }
   return wsz;
@@ -283,6 +288,7 @@ void AutoConnectOTA::_close(const HTTPUploadStatus status) {
       }
       if (ec) {
         _status = OTA_SUCCESS;
+        AutoConnectWear::commit(AC_WEARSUBSYS_OTA, _dest == OTA_DEST_FIRM ? AC_WEARREGION_APP : AC_WEARREGION_FS);
         AC_DBG_DUMB("succeeds");
       }
       else {
@@ -297,6 +303,7 @@ void AutoConnectOTA::_close(const HTTPUploadStatus status) {
     }
   }
   AC_DBG_DUMB(". %s\n", _err.c_str());
+  AC_EVENTS(AutoConnectEvents::end(PSTR("ota")));
   if (_tickerPort != -1)
     digitalWrite(_tickerPort, !_tickerOn);
 }
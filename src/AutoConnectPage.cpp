@@ -17,6 +17,7 @@ extern "C" {
 #include <WiFi.h>
 #define ENC_TYPE_NONE WIFI_AUTH_OPEN
 #endif
+#include <StreamString.h>
 #include "AutoConnect.h"
 #include "AutoConnectPage.h"
 #include "AutoConnectCredential.h"
@@ -738,6 +739,14 @@ const char  AutoConnect::_PAGE_OPENCREDT[] PROGMEM = {
   "</html>"
 };
 
+// With AUTOCONNECT_USE_EVENTS, the conclusion of the connection attempt
+// is pushed over the event stream and the timer remains as the fallback.
+#ifdef AUTOCONNECT_USE_EVENTS
+#define AUTOCONNECT_CONNECTING_SUBSCRIBE  "if(window.EventSource)new EventSource('" AUTOCONNECT_URI_EVENTS "').addEventListener('status',function(e){JSON.parse(e.data).connecting||link()});"
+#else
+#define AUTOCONNECT_CONNECTING_SUBSCRIBE  ""
+#endif
+
 /**< A page that informs during a connection attempting. */
 const char  AutoConnect::_PAGE_CONNECTING[] PROGMEM = {
   "{{REQ}}"
@@ -762,6 +771,7 @@ const char  AutoConnect::_PAGE_CONNECTING[] PROGMEM = {
     "<script type=\"text/javascript\">"
       "setTimeout(\"link()\"," AUTOCONNECT_STRING_DEPLOY(AUTOCONNECT_RESPONSE_WAITTIME) ");"
       "function link(){location.href='" AUTOCONNECT_URI_RESULT "';}"
+      AUTOCONNECT_CONNECTING_SUBSCRIBE
     "</script>"
   "</body>"
   "</html>"
@@ -906,54 +916,77 @@ uint32_t AutoConnect::_getFlashChipRealSize() {
 #endif
 }
 
+uint32_t AutoConnect::_getMaxFreeBlock() {
+#if defined(ARDUINO_ARCH_ESP8266)
+  return ESP.getMaxFreeBlockSize();
+#elif defined(ARDUINO_ARCH_ESP32)
+  return ESP.getMaxAllocHeap();
+#endif
+}
+
 String AutoConnect::_token_CSS_BASE(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_CSS_BASE");
   AC_UNUSED(args);
   return String(FPSTR(_CSS_BASE));
 }
 
 String AutoConnect::_token_CSS_ICON_LOCK(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_CSS_ICON_LOCK");
   AC_UNUSED(args);
   return String(FPSTR(_CSS_ICON_LOCK));
 }
 
 String AutoConnect::_token_CSS_INPUT_BUTTON(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_CSS_INPUT_BUTTON");
   AC_UNUSED(args);
   return String(FPSTR(_CSS_INPUT_BUTTON));
 }
 
 String AutoConnect::_token_CSS_INPUT_TEXT(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_CSS_INPUT_TEXT");
   AC_UNUSED(args);
   return String(FPSTR(_CSS_INPUT_TEXT));
 }
 
 String AutoConnect::_token_CSS_LUXBAR(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_CSS_LUXBAR");
   AC_UNUSED(args);
+  // The menu is dropped in the low memory mode, and so is its style.
+  if (_lowMemory)
+    return _emptyString;
   return String(FPSTR(_CSS_LUXBAR));
 }
 
 String AutoConnect::_token_CSS_SPINNER(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_CSS_SPINNER");
   AC_UNUSED(args);
   return String(FPSTR(_CSS_SPINNER));
 }
 
 String AutoConnect::_token_CSS_TABLE(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_CSS_TABLE");
   AC_UNUSED(args);
   return String(FPSTR(_CSS_TABLE));
 }
 
 String AutoConnect::_token_CSS_UL(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_CSS_UL");
   AC_UNUSED(args);
   return String(FPSTR(_CSS_UL));
 }
 
 String AutoConnect::_token_MENU_AUX(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_MENU_AUX");
   String  menuItem = String("");
-  if (_aux)
+  if (_aux && !_lowMemory)
     menuItem = _aux->_injectMenu(args);
   return menuItem;
 }
 
 String AutoConnect::_token_MENU_PRE(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_MENU_PRE");
+  if (_lowMemory)
+    return _emptyString;
   String  currentMenu = FPSTR(_ELM_MENU_PRE);
   String  menuItem = _attachMenuItem(AC_MENUITEM_CONFIGNEW) +
                      _attachMenuItem(AC_MENUITEM_OPENSSIDS) +
@@ -967,7 +1000,10 @@ String AutoConnect::_token_MENU_PRE(PageArgument& args) {
 }
 
 String AutoConnect::_token_MENU_POST(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_MENU_POST");
   AC_UNUSED(args);
+  if (_lowMemory)
+    return _emptyString;
   String  postMenu = FPSTR(_ELM_MENU_POST);
   postMenu.replace(String(F("MENU_HOME")), _attachMenuItem(AC_MENUITEM_HOME));
   postMenu.replace(String(F("HOME_URI")), _apConfig.homeUri);
@@ -976,6 +1012,7 @@ String AutoConnect::_token_MENU_POST(PageArgument& args) {
 }
 
 String AutoConnect::_token_AP_MAC(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_AP_MAC");
   AC_UNUSED(args);
   uint8_t macAddress[6];
   WiFi.softAPmacAddress(macAddress);
@@ -983,21 +1020,25 @@ String AutoConnect::_token_AP_MAC(PageArgument& args) {
 }
 
 String AutoConnect::_token_BOOTURI(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_BOOTURI");
   AC_UNUSED(args);
   return _getBootUri();
 }
 
 String AutoConnect::_token_CHANNEL(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_CHANNEL");
   AC_UNUSED(args);
   return String(WiFi.channel());
 }
 
 String AutoConnect::_token_CHIP_ID(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_CHIP_ID");
   AC_UNUSED(args);
   return String(_getChipId());
 }
 
 String AutoConnect::_token_CONFIG_STAIP(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_CONFIG_STAIP");
   AC_UNUSED(args);
   static const char _configIPList[] PROGMEM =
     "<li class=\"exp\">"
@@ -1037,11 +1078,13 @@ String AutoConnect::_token_CONFIG_STAIP(PageArgument& args) {
 }
 
 String AutoConnect::_token_CPU_FREQ(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_CPU_FREQ");
   AC_UNUSED(args);
   return String(ESP.getCpuFreqMHz());
 }
 
 String AutoConnect::_token_CURRENT_SSID(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_CURRENT_SSID");
   AC_UNUSED(args);
   char  ssid_c[sizeof(station_config_t::ssid) + 1];
   *ssid_c = '\0';
@@ -1051,42 +1094,50 @@ String AutoConnect::_token_CURRENT_SSID(PageArgument& args) {
 }
 
 String AutoConnect::_token_DBM(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_DBM");
   AC_UNUSED(args);
   int32_t dBm = WiFi.RSSI();
   return (dBm == 31 ? String(F("N/A")) : String(dBm));
 }
 
 String AutoConnect::_token_ESTAB_SSID(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_ESTAB_SSID");
   AC_UNUSED(args);
   return (WiFi.status() == WL_CONNECTED ? WiFi.SSID() : String(F("N/A")));
 }
 
 String AutoConnect::_token_FLASH_SIZE(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_FLASH_SIZE");
   AC_UNUSED(args);
   return String(_getFlashChipRealSize());
 }
 
 String AutoConnect::_token_FREE_HEAP(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_FREE_HEAP");
   AC_UNUSED(args);
   return String(_freeHeapSize);
 }
 
 String AutoConnect::_token_GATEWAY(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_GATEWAY");
   AC_UNUSED(args);
   return WiFi.gatewayIP().toString();
 }
 
 String AutoConnect::_token_HEAD(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_HEAD");
   AC_UNUSED(args);
   return String(FPSTR(_ELM_HTML_HEAD));
 }
 
 String AutoConnect::_token_HIDDEN_COUNT(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_HIDDEN_COUNT");
   AC_UNUSED(args);
   return String(_hiddenSSIDCount);
 }
 
 String AutoConnect::_token_LIST_SSID(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_LIST_SSID");
   // Obtain the page number to display.
   // When the display request is the first page, it will be obtained
   // from the scan results of the WiFiScan class if it has already been
@@ -1094,22 +1145,47 @@ String AutoConnect::_token_LIST_SSID(PageArgument& args) {
   uint8_t page = 0;
   if (args.hasArg(String(F("page"))))
     page = args.arg("page").toInt();
-  else {
-    // Scan at a first time
-    _scanCount = WiFi.scanNetworks(false, true);
-    AC_DBG("%d network(s) found, ", (int)_scanCount);
-  }
+  else
+    _scanForList();
+  // The list is shortened in the low memory mode.
+  const uint8_t lines = _lowMemory ? AUTOCONNECT_SSIDPAGEUNIT_LOWMEMORY : AUTOCONNECT_SSIDPAGEUNIT_LINES;
   // Prepare SSID list content building buffer
-  size_t  bufSize = sizeof('\0') + 192 * (_scanCount > AUTOCONNECT_SSIDPAGEUNIT_LINES ? AUTOCONNECT_SSIDPAGEUNIT_LINES : _scanCount);
-  bufSize += 88 * (_scanCount > AUTOCONNECT_SSIDPAGEUNIT_LINES ? (_scanCount > (AUTOCONNECT_SSIDPAGEUNIT_LINES * 2) ? 2 : 1) : 0);
+  size_t  bufSize = sizeof('\0') + 192 * (_scanCount > lines ? lines : _scanCount);
+  bufSize += 88 * (_scanCount > lines ? (_scanCount > (lines * 2) ? 2 : 1) : 0);
   AC_DBG_DUMB("%d buf", bufSize);
-  char* ssidList = (char*)malloc(bufSize);
-  if (!ssidList) {
+  StreamString  ssidList;
+  if (!ssidList.reserve(bufSize)) {
     AC_DBG_DUMB(" alloc. failed\n");
     WiFi.scanDelete();
     return _emptyString;
   }
   AC_DBG_DUMB("\n");
+  _listSSID(ssidList, page);
+  return ssidList;
+}
+
+/**
+ *  Scan the networks to be listed on the configuration page.
+ */
+void AutoConnect::_scanForList(void) {
+  AC_METRICS(_metrics.beginScan());
+  AC_TRACE(AC_TRACEID_SCANSTART, 0, false);
+  _scanCount = WiFi.scanNetworks(false, true);
+  AC_METRICS(_metrics.endScan());
+  AC_TRACE(AC_TRACEID_SCANEND, _scanCount, 0);
+  AC_EVENTS(AutoConnectEvents::push(PSTR("scan"), _scanCount));
+  AC_DBG("%d network(s) found, ", (int)_scanCount);
+}
+
+/**
+ *  Output the rows of the available SSIDs in the page one by one, with
+ *  the buttons to the previous and the next page. Each row is formatted
+ *  into a buffer of a row, so the memory does not depend on the number
+ *  of the networks found.
+ *  @param  out   Output destination.
+ *  @param  page  Page number to be listed.
+ */
+void AutoConnect::_listSSID(Print& out, const uint8_t page) {
   // Locate to the page and build SSD list content.
   static const char _ssidList[] PROGMEM =
     "<input type=\"button\" onClick=\"onFocus(this.getAttribute('value'))\" value=\"%s\">"
@@ -1118,21 +1194,23 @@ String AutoConnect::_token_LIST_SSID(PageArgument& args) {
     "<span class=\"img-lock\"></span>";
   static const char _ssidPage[] PROGMEM =
     "<button type=\"submit\" name=\"page\" value=\"%d\" formaction=\"" AUTOCONNECT_URI_CONFIG "\">%s</button>&emsp;";
+  // The list is shortened in the low memory mode.
+  const uint8_t lines = _lowMemory ? AUTOCONNECT_SSIDPAGEUNIT_LOWMEMORY : AUTOCONNECT_SSIDPAGEUNIT_LINES;
+  char  row[192];
   _hiddenSSIDCount = 0;
   uint8_t validCount = 0;
   uint8_t dispCount = 0;
-  char* slBuf = ssidList;
-  *slBuf = '\0';
   for (uint8_t i = 0; i < _scanCount; i++) {
     String ssid = WiFi.SSID(i);
     if (ssid.length() > 0) {
       // An available SSID may be listed.
       // AUTOCONNECT_SSIDPAGEUNIT_LINES determines the number of lines
-      // per page in the available SSID list.
-      if (validCount >= page * AUTOCONNECT_SSIDPAGEUNIT_LINES && validCount <= (page + 1) * AUTOCONNECT_SSIDPAGEUNIT_LINES - 1) {
-        if (++dispCount <= AUTOCONNECT_SSIDPAGEUNIT_LINES) {
-          snprintf_P(slBuf, bufSize - (slBuf - ssidList), (PGM_P)_ssidList, ssid.c_str(), AutoConnect::_toWiFiQuality(WiFi.RSSI(i)), WiFi.channel(i), WiFi.encryptionType(i) != ENC_TYPE_NONE ? (PGM_P)_ssidEnc : "");
-          slBuf += strlen(slBuf);
+      // per page in the available SSID list. It is shortened
+      // to AUTOCONNECT_SSIDPAGEUNIT_LOWMEMORY in the low memory mode.
+      if (validCount >= page * lines && validCount <= (page + 1) * lines - 1) {
+        if (++dispCount <= lines) {
+          snprintf_P(row, sizeof(row), (PGM_P)_ssidList, ssid.c_str(), AutoConnect::_toWiFiQuality(WiFi.RSSI(i)), WiFi.channel(i), WiFi.encryptionType(i) != ENC_TYPE_NONE ? (PGM_P)_ssidEnc : "");
+          out.print(row);
         }
       }
       // The validCount counts the found SSIDs that is not the Hidden
@@ -1144,29 +1222,30 @@ String AutoConnect::_token_LIST_SSID(PageArgument& args) {
   }
   // Prepare perv. button
   if (page >= 1) {
-    snprintf_P(slBuf, bufSize - (slBuf - ssidList), (PGM_P)_ssidPage, page - 1, PSTR("Prev."));
-    slBuf = ssidList + strlen(ssidList);
+    snprintf_P(row, sizeof(row), (PGM_P)_ssidPage, page - 1, PSTR("Prev."));
+    out.print(row);
   }
   // Prepare next button
-  if (validCount > (page + 1) * AUTOCONNECT_SSIDPAGEUNIT_LINES) {
-    snprintf_P(slBuf, bufSize - (slBuf - ssidList), (PGM_P)_ssidPage, page + 1, PSTR("Next"));
+  if (validCount > (page + 1) * lines) {
+    snprintf_P(row, sizeof(row), (PGM_P)_ssidPage, page + 1, PSTR("Next"));
+    out.print(row);
   }
-  String ssidListStr = String(ssidList);
-  free(ssidList);
-  return ssidListStr;
 }
 
 String AutoConnect::_token_LOCAL_IP(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_LOCAL_IP");
   AC_UNUSED(args);
   return WiFi.localIP().toString();
 }
 
 String AutoConnect::_token_NETMASK(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_NETMASK");
   AC_UNUSED(args);
   return WiFi.subnetMask().toString();
 }
 
 String AutoConnect::_token_OPEN_SSID(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_OPEN_SSID");
   AC_UNUSED(args);
   static const char _ssidList[] PROGMEM = "<input id=\"sb\" type=\"submit\" name=\"%s\" value=\"%s\"><label class=\"slist\">%s</label>%s<br>";
   static const char _ssidRssi[] PROGMEM = "%d&#037;&ensp;Ch.%d";
@@ -1182,7 +1261,12 @@ String AutoConnect::_token_OPEN_SSID(PageArgument& args) {
   uint8_t creEntries = credit.entries();
   if (creEntries > 0) {
     ssidList = String("");
+    AC_METRICS(_metrics.beginScan());
+    AC_TRACE(AC_TRACEID_SCANSTART, 0, false);
     _scanCount = WiFi.scanNetworks(false, true);
+    AC_METRICS(_metrics.endScan());
+    AC_TRACE(AC_TRACEID_SCANEND, _scanCount, 0);
+    AC_EVENTS(AutoConnectEvents::push(PSTR("scan"), _scanCount));
   }
   else
     ssidList = String(F("<p><b>" AUTOCONNECT_TEXT_NOSAVEDCREDENTIALS "</b></p>"));
@@ -1213,16 +1297,19 @@ String AutoConnect::_token_OPEN_SSID(PageArgument& args) {
 }
 
 String AutoConnect::_token_SOFTAP_IP(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_SOFTAP_IP");
   AC_UNUSED(args);
   return WiFi.softAPIP().toString();
 }
 
 String AutoConnect::_token_SSID_COUNT(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_SSID_COUNT");
   AC_UNUSED(args);
   return String(_scanCount);
 }
 
 String AutoConnect::_token_STA_MAC(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_STA_MAC");
   AC_UNUSED(args);
   uint8_t macAddress[6];
   WiFi.macAddress(macAddress);
@@ -1230,6 +1317,7 @@ String AutoConnect::_token_STA_MAC(PageArgument& args) {
 }
 
 String AutoConnect::_token_STATION_STATUS(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_STATION_STATUS");
   AC_UNUSED(args);
   PGM_P wlStatusSymbol = PSTR("");
   PGM_P wlStatusSymbols[] = {
@@ -1301,11 +1389,13 @@ String AutoConnect::_token_STATION_STATUS(PageArgument& args) {
 }
 
 String AutoConnect::_token_UPTIME(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_UPTIME");
   AC_UNUSED(args);
   return String(_apConfig.uptime);
 }
 
 String AutoConnect::_token_WIFI_MODE(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_WIFI_MODE");
   AC_UNUSED(args);
   PGM_P wifiMode;
   switch (WiFi.getMode()) {
@@ -1333,6 +1423,7 @@ String AutoConnect::_token_WIFI_MODE(PageArgument& args) {
 }
 
 String AutoConnect::_token_WIFI_STATUS(PageArgument& args) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_token_WIFI_STATUS");
   AC_UNUSED(args);
   return String(WiFi.status());
 }
@@ -1395,6 +1486,7 @@ String AutoConnect::_attachMenuItem(const AC_MENUITEM_t item) {
  *  @retval false Requested uri is not defined.
  */
 PageElement* AutoConnect::_setupPage(String& uri) {
+  AC_HEAPTRACE_SCOPE("AutoConnect::_setupPage");
   PageElement *elm = new PageElement();
   bool  reqAuth = false;
 
@@ -1549,12 +1641,13 @@ PageElement* AutoConnect::_setupPage(String& uri) {
 
   // Restore the page transfer mode and the content build buffer
   // reserved size corresponding to each URI defined in structure
-  // _pageBuildMode.
+  // _pageBuildMode. In the low memory mode, the page is streamed by
+  // the chunks without the reserved buffer.
   if (elm) {
     for (uint8_t n = 0; n < sizeof(_pageBuildMode) / sizeof(PageTranserModeST); n++)
       if (!strcmp(_pageBuildMode[n].uri, uri.c_str())) {
-        _responsePage->reserve(_pageBuildMode[n].rSize);
-        _responsePage->chunked(_pageBuildMode[n].transMode);
+        _responsePage->reserve(_lowMemory ? 0 : _pageBuildMode[n].rSize);
+        _responsePage->chunked(_lowMemory ? PB_Chunk : _pageBuildMode[n].transMode);
         break;
       }
 
@@ -1595,7 +1688,24 @@ void AutoConnect::_authentication(bool allow, const HTTPAuthMethod method) {
   const char* password = nullptr;
   String  fails;
 
-  // Enable authentication by setting of AC_AUTHSCOPE_DISCONNECTED even if WiFi is not connected.
+  if (_allowAuthentication(allow)) {
+    // Regiter authentication method
+    user = _apConfig.username.length() ? _apConfig.username.c_str() : _apConfig.apid.c_str();
+    password = _apConfig.password.length() ? _apConfig.password.c_str() : _apConfig.psk.c_str();
+    fails = String(FPSTR(AutoConnect::_ELM_HTML_HEAD)) + String(F("</head><body>" AUTOCONNECT_TEXT_AUTHFAILED "</body></html>"));
+    AC_DBG_DUMB(",%s+%s/%s", method == HTTPAuthMethod::BASIC_AUTH ? "BASIC" : "DIGEST", user, password);
+  }
+  _responsePage->authentication(user, password, method, AUTOCONNECT_AUTH_REALM, fails);
+}
+
+/**
+ *  Determine whether the authentication is applied to the request.
+ *  Enable authentication by setting of AC_AUTHSCOPE_WITHCP even if WiFi
+ *  is not connected.
+ *  @param allow  Indication of whether to authenticate with the page.
+ *  @return true  The request should be authenticated.
+ */
+bool AutoConnect::_allowAuthentication(bool allow) {
   if (WiFi.status() != WL_CONNECTED && (WiFi.getMode() & WIFI_AP)) {
     String  accUrl = _webServer->hostHeader();
     if ((accUrl != WiFi.softAPIP().toString()) && !accUrl.endsWith(F(".local"))) {
@@ -1603,13 +1713,128 @@ void AutoConnect::_authentication(bool allow, const HTTPAuthMethod method) {
         allow = false;
     }
   }
+  return allow;
+}
 
-  if (allow) {
-    // Regiter authentication method
-    user = _apConfig.username.length() ? _apConfig.username.c_str() : _apConfig.apid.c_str();
-    password = _apConfig.password.length() ? _apConfig.password.c_str() : _apConfig.psk.c_str();
-    fails = String(FPSTR(AutoConnect::_ELM_HTML_HEAD)) + String(F("</head><body>" AUTOCONNECT_TEXT_AUTHFAILED "</body></html>"));
-    AC_DBG_DUMB(",%s+%s/%s", method == HTTPAuthMethod::BASIC_AUTH ? "BASIC" : "DIGEST", user, password);
+/**
+ *  Authenticate the request answered directly by the web server without
+ *  PageBuilder, as the page built by PageBuilder is authenticated with
+ *  the AutoConnectConfig settings. If the credentials are not given,
+ *  it requests the authentication from the client.
+ *  @return true  The request is allowed to be answered.
+ */
+bool AutoConnect::_authenticateRequest(void) {
+  if (_allowAuthentication((_apConfig.auth != AC_AUTH_NONE) && (_apConfig.authScope & AC_AUTHSCOPE_AC))) {
+    const char* user = _apConfig.username.length() ? _apConfig.username.c_str() : _apConfig.apid.c_str();
+    const char* password = _apConfig.password.length() ? _apConfig.password.c_str() : _apConfig.psk.c_str();
+    if (!_webServer->authenticate(user, password)) {
+      HTTPAuthMethod  method = _apConfig.auth == AC_AUTH_BASIC ? HTTPAuthMethod::BASIC_AUTH : HTTPAuthMethod::DIGEST_AUTH;
+      _webServer->requestAuthentication(method, AUTOCONNECT_AUTH_REALM, String(FPSTR(AutoConnect::_ELM_HTML_HEAD)) + String(F("</head><body>" AUTOCONNECT_TEXT_AUTHFAILED "</body></html>")));
+      return false;
+    }
   }
-  _responsePage->authentication(user, password, method, AUTOCONNECT_AUTH_REALM, fails);
+  return true;
+}
+
+#ifdef AUTOCONNECT_USE_STREAMCONFIG
+// The tokens of the configuration page streamed by _handleConfig. The
+// style sheets are written directly from PROGMEM, and LIST_SSID is
+// written row by row.
+const AutoConnect::StreamTokenST AutoConnect::_configTokens[] = {
+  { "HEAD",             nullptr,            &AutoConnect::_token_HEAD },
+  { "CSS_BASE",         _CSS_BASE,          nullptr },
+  { "CSS_ICON_LOCK",    _CSS_ICON_LOCK,     nullptr },
+  { "CSS_UL",           _CSS_UL,            nullptr },
+  { "CSS_INPUT_BUTTON", _CSS_INPUT_BUTTON,  nullptr },
+  { "CSS_INPUT_TEXT",   _CSS_INPUT_TEXT,    nullptr },
+  { "CSS_LUXBAR",       nullptr,            &AutoConnect::_token_CSS_LUXBAR },
+  { "MENU_PRE",         nullptr,            &AutoConnect::_token_MENU_PRE },
+  { "MENU_AUX",         nullptr,            &AutoConnect::_token_MENU_AUX },
+  { "MENU_POST",        nullptr,            &AutoConnect::_token_MENU_POST },
+  { "LIST_SSID",        nullptr,            nullptr },
+  { "SSID_COUNT",       nullptr,            &AutoConnect::_token_SSID_COUNT },
+  { "HIDDEN_COUNT",     nullptr,            &AutoConnect::_token_HIDDEN_COUNT },
+  { "CONFIG_IP",        nullptr,            &AutoConnect::_token_CONFIG_STAIP }
+};
+
+/**
+ *  Respond the configuration page by streaming. The mold is expanded
+ *  through the fixed-size chunk window, and the SSID list is written
+ *  row by row into it. Therefore, the memory to build the page is
+ *  independent of the number of the networks found, unlike PageBuilder
+ *  which builds the whole page in the reserved content buffer.
+ */
+void AutoConnect::_handleConfig(void) {
+  AC_HEAPTRACE_ROUTE(AUTOCONNECT_URI_CONFIG);
+  if (!(_apConfig.menuItems & AC_MENUITEM_CONFIGNEW)) {
+    _handleNotFound();
+    return;
+  }
+  AC_METRICS(_markRequest(AC_METRICSROUTE_CONFIG));
+  _menuTitle = _apConfig.title;
+
+  if (!_authenticateRequest())
+    return;
+
+  _webServer->sendHeader(String(F("Cache-Control")), String(F("no-cache, no-store, must-revalidate")), true);
+  _webServer->sendHeader(String(F("Pragma")), String(F("no-cache")));
+  _webServer->sendHeader(String(F("Expires")), String("-1"));
+  _webServer->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  _webServer->send(200, String(F("text/html")), _emptyString);
+  {
+    AutoConnectChunk<WebServerClass>  window(*_webServer);
+    PageArgument  args;
+    PGM_P mold = _PAGE_CONFIGNEW;
+    char  c;
+    while ((c = pgm_read_byte(mold++))) {
+      // Expand the token enclosed with {{ }}.
+      if (c == '{' && pgm_read_byte(mold) == '{') {
+        char  token[20];
+        uint8_t n = 0;
+        PGM_P p = mold + 1;
+        while ((c = pgm_read_byte(p)) && c != '}' && n < sizeof(token) - 1) {
+          token[n++] = c;
+          p++;
+        }
+        token[n] = '\0';
+        if (c == '}' && pgm_read_byte(p + 1) == '}') {
+          _streamToken(window, token, args);
+          mold = p + 2;
+          continue;
+        }
+        c = '{';
+      }
+      window.write(static_cast<uint8_t>(c));
+    }
+  }
+  // Terminate the chunked transfer.
+  _webServer->sendContent(_emptyString);
+}
+
+/**
+ *  Write the token of the configuration page to the chunk window.
+ *  @param  out   Output destination.
+ *  @param  token Name of the token.
+ *  @param  args  Arguments of the request for the token handlers.
+ */
+void AutoConnect::_streamToken(AutoConnectChunk<WebServerClass>& out, const char* token, PageArgument& args) {
+  for (const StreamTokenST& entry : _configTokens) {
+    if (strcmp(entry.token, token))
+      continue;
+    if (entry.text)
+      out.writeP(entry.text);
+    else if (entry.builder)
+      out.print((this->*entry.builder)(args));
+    else {
+      uint8_t page = 0;
+      if (_webServer->hasArg(String(F("page"))))
+        page = _webServer->arg(String(F("page"))).toInt();
+      else
+        _scanForList();
+      _listSSID(out, page);
+    }
+    return;
+  }
+  AC_DBG("Token %s unknown\n", token);
 }
+#endif // !AUTOCONNECT_USE_STREAMCONFIG
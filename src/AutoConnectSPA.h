@@ -0,0 +1,132 @@
+/**
+ *  Precompressed single-page front end of the AutoConnect JSON API.
+ *  Generated by acspa/mkspa.py from acspa/index.html, do not edit.
+ *  @file   AutoConnectSPA.h
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTSPA_H_
+#define _AUTOCONNECTSPA_H_
+
+#include <Arduino.h>
+
+// Original size 3874 bytes, gzip compressed 1778 bytes
+static const uint8_t _autoconnectSPA[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x9d, 0x57, 0x7b, 0x73, 0xdb, 0x36,
+  0x12, 0xff, 0x2a, 0xac, 0xdc, 0x06, 0xd2, 0xe8, 0x69, 0x39, 0x71, 0x53, 0x52, 0x94, 0x47, 0x91,
+  0xec, 0x8b, 0x67, 0xfc, 0x9a, 0xc8, 0xb9, 0x4e, 0xc7, 0xa3, 0xf1, 0x40, 0xe0, 0xca, 0x42, 0x4c,
+  0x82, 0x2c, 0x00, 0x5a, 0xf6, 0xa9, 0xfa, 0xee, 0xb7, 0x00, 0x44, 0x8a, 0x72, 0x9c, 0xbb, 0x69,
+  0xff, 0x30, 0x0d, 0x2c, 0xf6, 0xf9, 0xdb, 0x07, 0xa0, 0xc1, 0x4f, 0x93, 0xeb, 0xf1, 0xed, 0x1f,
+  0x37, 0xa7, 0xde, 0x52, 0x27, 0xf1, 0x70, 0xb0, 0xfd, 0x02, 0x8d, 0x86, 0x83, 0x04, 0x34, 0xf5,
+  0xd8, 0x92, 0x4a, 0x05, 0x3a, 0xac, 0x7d, 0xbd, 0x3d, 0x6b, 0x7f, 0xac, 0x6d, 0xa9, 0x82, 0x26,
+  0x10, 0xd6, 0x9e, 0x38, 0xac, 0xb2, 0x54, 0xea, 0x9a, 0xc7, 0x52, 0xa1, 0x41, 0x20, 0xd7, 0x8a,
+  0x47, 0x7a, 0x19, 0x46, 0xf0, 0xc4, 0x19, 0xb4, 0xed, 0xa6, 0xc5, 0x05, 0xd7, 0x9c, 0xc6, 0x6d,
+  0xc5, 0x68, 0x0c, 0xe1, 0x21, 0xaa, 0xd0, 0x5c, 0xc7, 0x30, 0x1c, 0xe5, 0x3a, 0x1d, 0xa7, 0x42,
+  0x00, 0xd3, 0x83, 0xae, 0x23, 0x0d, 0x94, 0x7e, 0xc1, 0x7f, 0xc6, 0x89, 0xf5, 0x02, 0x55, 0xb6,
+  0x17, 0x34, 0xe1, 0xf1, 0x8b, 0xff, 0x19, 0xe2, 0x27, 0xd0, 0x9c, 0xd1, 0xd6, 0x48, 0xa2, 0xaa,
+  0x96, 0xa2, 0x42, 0xb5, 0x15, 0x48, 0xbe, 0x08, 0x2c, 0x9b, 0xe2, 0xff, 0x01, 0xff, 0xf0, 0x38,
+  0x7b, 0x0e, 0xda, 0x2b, 0x98, 0x3f, 0x72, 0xdd, 0xd6, 0xf0, 0xec, 0xc8, 0x6d, 0x1a, 0x7d, 0xcb,
+  0x95, 0xf6, 0x0f, 0x7b, 0xbd, 0x5f, 0x36, 0xf3, 0x34, 0x7a, 0x59, 0x27, 0x54, 0x3e, 0x70, 0xe1,
+  0xf7, 0x82, 0x8c, 0x46, 0x11, 0x17, 0x0f, 0x7e, 0x6f, 0x63, 0xe2, 0x05, 0xb9, 0x9e, 0x53, 0xf6,
+  0xf8, 0x20, 0xd3, 0x5c, 0x44, 0xfe, 0x41, 0xff, 0xf8, 0xa8, 0x7f, 0xf4, 0x31, 0x60, 0x69, 0x9c,
+  0x4a, 0xff, 0x60, 0xb1, 0x58, 0x94, 0xec, 0x87, 0xfd, 0xec, 0xd9, 0xeb, 0xe3, 0xc7, 0xd9, 0x5e,
+  0x01, 0x7f, 0x58, 0x6a, 0x7f, 0x9e, 0xc6, 0xd1, 0x46, 0x61, 0x2c, 0x3c, 0x15, 0xa5, 0x09, 0xcb,
+  0xe6, 0x19, 0xc7, 0xec, 0x6a, 0xb3, 0x3c, 0x5a, 0xcf, 0x53, 0x89, 0xa6, 0xda, 0xf3, 0x54, 0xeb,
+  0x34, 0xf1, 0x0f, 0xf1, 0x44, 0xa5, 0x31, 0x8f, 0xbc, 0x03, 0xc6, 0x58, 0x61, 0xa2, 0x38, 0x7d,
+  0x8f, 0x22, 0x9a, 0xce, 0x63, 0x28, 0xa4, 0xd0, 0x9b, 0x98, 0x66, 0x0a, 0xfc, 0x62, 0x11, 0x58,
+  0x88, 0x5d, 0x70, 0x3a, 0x5a, 0x17, 0x2e, 0xa2, 0xa0, 0xd7, 0x0b, 0x7e, 0x68, 0x0a, 0x00, 0x90,
+  0xdb, 0x5f, 0x70, 0xa9, 0x74, 0x9b, 0x2d, 0x79, 0x1c, 0xad, 0xb7, 0x71, 0x7e, 0xf8, 0xf0, 0x61,
+  0xab, 0xf2, 0x3d, 0x6a, 0x8c, 0xf9, 0x3a, 0xe6, 0xc8, 0x62, 0xb3, 0xe2, 0x8b, 0x54, 0x40, 0x09,
+  0xc2, 0xf1, 0xff, 0xb5, 0x10, 0xb0, 0x5c, 0x2a, 0xd4, 0x99, 0xa5, 0x1c, 0x6b, 0x43, 0x6e, 0xf2,
+  0xb8, 0x74, 0xaf, 0x17, 0x14, 0x00, 0xa1, 0x09, 0x4f, 0x65, 0x54, 0xac, 0x17, 0x71, 0x4a, 0xb5,
+  0x2f, 0x0d, 0x94, 0xc1, 0xce, 0x97, 0x0d, 0x17, 0x59, 0xae, 0x31, 0xfa, 0x67, 0x93, 0x4b, 0x23,
+  0x5a, 0x5a, 0x7c, 0xae, 0x84, 0x5e, 0x7a, 0xf5, 0x11, 0x93, 0xb2, 0x55, 0x5d, 0x85, 0xe0, 0x35,
+  0xcc, 0x5b, 0x25, 0x92, 0x46, 0x3c, 0x57, 0xbe, 0x49, 0xcc, 0x3c, 0xc7, 0x08, 0xc4, 0xba, 0xa2,
+  0xc7, 0x66, 0xad, 0xaa, 0xac, 0xf8, 0x2b, 0x95, 0xf6, 0xbe, 0xd7, 0x13, 0x54, 0x2b, 0xe8, 0xf0,
+  0xb7, 0x5f, 0x8f, 0xa3, 0x7e, 0xb5, 0x82, 0x5e, 0x21, 0xe2, 0x8c, 0x76, 0x56, 0x7b, 0x75, 0x17,
+  0x1d, 0xf5, 0x17, 0xfd, 0xc5, 0xe6, 0x20, 0x51, 0x0f, 0x45, 0x52, 0x1c, 0x29, 0x48, 0xb8, 0x68,
+  0x2f, 0x5d, 0xb1, 0x1d, 0x42, 0xb2, 0x19, 0x74, 0x5d, 0xb3, 0x0c, 0xba, 0xae, 0x5b, 0x4d, 0x6d,
+  0xbb, 0xce, 0x05, 0xb9, 0xdf, 0x5b, 0x5b, 0xda, 0x60, 0x5b, 0x9d, 0xc8, 0x74, 0x34, 0x9c, 0x6a,
+  0xaa, 0x73, 0x85, 0x67, 0x47, 0xd8, 0x8e, 0xa6, 0xc4, 0x3c, 0x1e, 0x85, 0x35, 0xa5, 0xb1, 0x3b,
+  0xbb, 0x76, 0x8f, 0xff, 0x4b, 0xfe, 0xaa, 0xe0, 0x15, 0xe8, 0x55, 0x2a, 0x1f, 0x95, 0x37, 0x70,
+  0xee, 0x3b, 0x39, 0x56, 0x1b, 0x4e, 0x19, 0x15, 0x83, 0xae, 0x23, 0x0e, 0x9d, 0xe2, 0x3c, 0xb6,
+  0xa7, 0x62, 0x65, 0xb4, 0xe6, 0xf1, 0x8f, 0x54, 0xee, 0x1c, 0x45, 0x19, 0x9b, 0x71, 0xa7, 0x54,
+  0xf1, 0xa8, 0xe6, 0x65, 0x31, 0x65, 0xb0, 0xc4, 0xe6, 0x02, 0x19, 0xd6, 0xa6, 0xd3, 0xf3, 0x49,
+  0xcd, 0x4b, 0xe8, 0x73, 0x0c, 0xe2, 0x01, 0xe7, 0x4c, 0xed, 0xa8, 0x5f, 0xab, 0x8a, 0x64, 0x54,
+  0xa9, 0x9a, 0xa7, 0x5f, 0x32, 0x70, 0x6b, 0xf4, 0xf4, 0xb5, 0x8a, 0x1b, 0x24, 0x67, 0x4b, 0x49,
+  0x15, 0xec, 0x29, 0x3a, 0x7e, 0x8f, 0x8a, 0x2a, 0x11, 0x31, 0x51, 0xdb, 0xf9, 0x55, 0x04, 0x15,
+  0xf1, 0x27, 0x7b, 0x88, 0xb9, 0x31, 0x11, 0xe1, 0xf6, 0x47, 0x21, 0x4d, 0xe9, 0x13, 0x44, 0x7b,
+  0x20, 0x30, 0xf9, 0x3f, 0x40, 0xa8, 0x18, 0x96, 0x18, 0x00, 0x8b, 0xd1, 0x49, 0x9c, 0xa5, 0xb5,
+  0xe1, 0x17, 0xc0, 0xd9, 0x5b, 0x41, 0x75, 0x27, 0xca, 0x24, 0xcf, 0xf4, 0xb0, 0xbe, 0xc8, 0x85,
+  0xa5, 0xd4, 0x1b, 0xeb, 0x27, 0x2a, 0x3d, 0x9a, 0xf1, 0x90, 0xe0, 0xa7, 0x4b, 0x5a, 0x3f, 0x87,
+  0xe5, 0x19, 0x6f, 0xac, 0x25, 0xe8, 0x5c, 0x0a, 0x2f, 0x4a, 0x59, 0x9e, 0xe0, 0xa0, 0xee, 0x3c,
+  0x80, 0x3e, 0x8d, 0xc1, 0x2c, 0x3f, 0xbd, 0x9c, 0x47, 0xc8, 0xb1, 0x09, 0x8c, 0xfc, 0xef, 0x17,
+  0xe1, 0x1d, 0x39, 0x9f, 0x5c, 0x9c, 0x92, 0x16, 0xb9, 0xba, 0xbe, 0x37, 0x78, 0xdf, 0x8f, 0xfe,
+  0x3d, 0x3a, 0xbf, 0xc0, 0xfd, 0x74, 0x3c, 0xba, 0xba, 0x1f, 0x5f, 0x5f, 0xde, 0x5c, 0x9c, 0xde,
+  0x9e, 0x4e, 0x90, 0x30, 0xbe, 0xbe, 0xba, 0x3a, 0x1d, 0xef, 0xad, 0xef, 0xcf, 0x90, 0xb7, 0x4a,
+  0x38, 0xbf, 0xbe, 0xba, 0xbf, 0xb8, 0x9e, 0xde, 0x22, 0x65, 0x72, 0x3e, 0xdd, 0x49, 0xcc, 0xac,
+  0xb9, 0xcb, 0x09, 0x9a, 0xbb, 0x3e, 0x3b, 0x33, 0xda, 0x6f, 0x47, 0xf8, 0x1d, 0xdd, 0xb8, 0x65,
+  0x13, 0x17, 0xb3, 0xa0, 0x08, 0xc0, 0x03, 0xc5, 0xea, 0xaa, 0x0c, 0x62, 0xaa, 0x25, 0x36, 0x29,
+  0x12, 0x3a, 0x12, 0x6c, 0x6e, 0xeb, 0xdd, 0xbb, 0x77, 0x83, 0x61, 0x8d, 0xcc, 0xba, 0x0f, 0xad,
+  0x32, 0x68, 0x56, 0xf2, 0x93, 0x77, 0x07, 0xa4, 0xc9, 0x3a, 0xe6, 0x26, 0x1b, 0xa7, 0x11, 0x8c,
+  0x74, 0xbd, 0xd7, 0x68, 0x92, 0x80, 0x6c, 0x1a, 0x9b, 0xd2, 0x02, 0xe2, 0x51, 0xcf, 0x4a, 0x89,
+  0x05, 0x68, 0xb6, 0xac, 0x23, 0x8e, 0xcd, 0xac, 0xb5, 0x66, 0x94, 0x2d, 0xc1, 0x27, 0x22, 0xc5,
+  0x39, 0x98, 0x4a, 0x40, 0xb1, 0x8e, 0x5e, 0x82, 0xd8, 0x41, 0x2f, 0x4b, 0x39, 0xd9, 0xf9, 0xa6,
+  0x4c, 0x2e, 0xaa, 0x9a, 0xb3, 0x54, 0xa1, 0xea, 0x16, 0x75, 0x09, 0x9a, 0x87, 0x02, 0x56, 0xde,
+  0xd7, 0x2f, 0x17, 0x53, 0xa0, 0x92, 0x2d, 0x6f, 0xa8, 0xa4, 0x89, 0xaa, 0x37, 0xf0, 0x2a, 0x91,
+  0x75, 0x73, 0xfe, 0xe8, 0x71, 0xe1, 0xd1, 0xc6, 0xbc, 0x43, 0xb3, 0x0c, 0x44, 0x54, 0x7f, 0x6c,
+  0xd1, 0xbb, 0xc7, 0x59, 0x23, 0x78, 0xcb, 0x31, 0xbc, 0x89, 0x97, 0x69, 0xe4, 0x93, 0x1b, 0x8b,
+  0xaf, 0xe9, 0x7f, 0x7f, 0xfe, 0x37, 0x9d, 0x53, 0x76, 0x0c, 0xd4, 0x4b, 0x1e, 0x03, 0x03, 0x71,
+  0x44, 0xf2, 0x5a, 0x93, 0x72, 0x11, 0xc8, 0xf0, 0xee, 0x8e, 0xb8, 0xf1, 0x41, 0x5a, 0xf5, 0xdf,
+  0x2f, 0xee, 0x54, 0xc7, 0x09, 0xcc, 0xfe, 0xfa, 0xab, 0x58, 0x36, 0x9a, 0x75, 0xd5, 0x61, 0xae,
+  0x7d, 0x30, 0x55, 0x27, 0xc4, 0xab, 0xef, 0x76, 0x0d, 0xe2, 0x13, 0xd2, 0x98, 0xb5, 0xee, 0xc8,
+  0x25, 0x66, 0x83, 0xb4, 0x2e, 0x27, 0xa8, 0x22, 0xc1, 0xe5, 0xcc, 0xd0, 0x4c, 0xc9, 0x91, 0x16,
+  0x2a, 0xc2, 0xee, 0x37, 0xfb, 0x4f, 0x05, 0x61, 0x5e, 0x50, 0xbe, 0x20, 0xc5, 0x10, 0x24, 0x12,
+  0x9a, 0xc4, 0x8b, 0x3e, 0x25, 0xc4, 0x90, 0xc7, 0x4b, 0x8a, 0x16, 0x62, 0x73, 0xc2, 0xdc, 0xd2,
+  0x50, 0xcf, 0x6f, 0x0c, 0x81, 0x67, 0x66, 0xfd, 0x2f, 0xaa, 0x61, 0x45, 0x5f, 0x0c, 0xe1, 0xc1,
+  0x2d, 0x0d, 0x15, 0x07, 0x5a, 0x42, 0xd5, 0xa3, 0xa1, 0x0a, 0xb7, 0xb4, 0x6e, 0xa4, 0x0b, 0x3d,
+  0xba, 0xf1, 0x9c, 0xb8, 0xc2, 0x0d, 0xb5, 0x2a, 0x2e, 0x47, 0x63, 0x43, 0x48, 0x28, 0x33, 0xbb,
+  0x33, 0x09, 0xe0, 0x25, 0x90, 0xa4, 0xd2, 0x2a, 0xc5, 0x39, 0x6b, 0x99, 0xbe, 0x66, 0x9a, 0x27,
+  0x60, 0x28, 0xb9, 0x5d, 0xa1, 0x93, 0x8a, 0xcc, 0x66, 0xc1, 0xcf, 0x06, 0x5a, 0x84, 0x95, 0xa3,
+  0x73, 0xf2, 0xf3, 0xed, 0xe5, 0x45, 0x28, 0x51, 0x53, 0xb6, 0x43, 0x18, 0x76, 0x25, 0x3b, 0xd0,
+  0x38, 0xb0, 0x75, 0x34, 0x24, 0x4d, 0xb8, 0xeb, 0xcd, 0x9a, 0x04, 0xa7, 0x72, 0x54, 0x10, 0xb0,
+  0x19, 0xb6, 0x2d, 0x00, 0x77, 0x87, 0xb3, 0x46, 0xa3, 0x38, 0xed, 0xa2, 0x8c, 0xa9, 0xce, 0x6f,
+  0x78, 0xbf, 0xd4, 0x11, 0xe2, 0xa2, 0x68, 0x54, 0xb0, 0x69, 0x04, 0x95, 0x9c, 0xe3, 0xa0, 0xc6,
+  0x8c, 0xa3, 0x37, 0x62, 0xb5, 0xe7, 0x0d, 0x19, 0xc4, 0xdc, 0x8e, 0x71, 0x81, 0xba, 0x3b, 0x9d,
+  0xce, 0xa0, 0x8b, 0x7b, 0x12, 0xb8, 0x9a, 0x40, 0xf2, 0x77, 0x15, 0x21, 0xde, 0xd2, 0x22, 0x0c,
+  0x8c, 0xf6, 0x8a, 0xd8, 0x0f, 0x6e, 0x55, 0x09, 0x0e, 0x6f, 0xfd, 0x88, 0x6a, 0xda, 0xc6, 0x21,
+  0xe7, 0xe2, 0x59, 0xd9, 0x7c, 0x63, 0x24, 0xb5, 0xe1, 0x3e, 0xc1, 0x2c, 0x00, 0xef, 0x4d, 0xc0,
+  0x1a, 0x7a, 0x77, 0x70, 0xd8, 0xff, 0xd8, 0xff, 0xf5, 0x7d, 0x60, 0x0b, 0x08, 0xa3, 0x36, 0x2f,
+  0x07, 0xe4, 0x5f, 0x75, 0xfe, 0xcc, 0x69, 0xcc, 0xf5, 0x4b, 0x93, 0xfc, 0xe2, 0x8d, 0x97, 0x1d,
+  0x43, 0xd9, 0x96, 0x80, 0x81, 0xc6, 0x72, 0xb9, 0x58, 0x2a, 0xe0, 0x34, 0xeb, 0xa2, 0xb3, 0xe4,
+  0x51, 0x04, 0xe2, 0xc4, 0xc6, 0xfd, 0xd9, 0xae, 0x7d, 0x8f, 0x34, 0x0b, 0xba, 0x91, 0x35, 0x42,
+  0xc6, 0xd8, 0x2b, 0x04, 0xcd, 0x74, 0x47, 0x08, 0x2d, 0x32, 0x4c, 0x02, 0x32, 0x9b, 0x17, 0xee,
+  0xf7, 0x2d, 0xc3, 0x2c, 0x40, 0x4c, 0xee, 0x01, 0x84, 0x93, 0x68, 0x27, 0xf2, 0xe3, 0x02, 0x30,
+  0xa6, 0x2d, 0x14, 0x50, 0x60, 0x53, 0xc4, 0x8b, 0x94, 0x68, 0xc9, 0xb2, 0x13, 0x32, 0xf9, 0x3c,
+  0xbe, 0x21, 0xbe, 0xe3, 0xe1, 0x99, 0x29, 0x84, 0xf2, 0x56, 0x2e, 0xaf, 0x10, 0x07, 0x74, 0x54,
+  0x00, 0x0d, 0x3b, 0xa0, 0x27, 0x10, 0x83, 0x86, 0xea, 0xe5, 0xf2, 0x26, 0x50, 0xfb, 0xa1, 0xaf,
+  0x28, 0xd7, 0x18, 0x39, 0xde, 0x4a, 0xb7, 0x58, 0xd9, 0x69, 0xae, 0xab, 0x37, 0x50, 0x31, 0x4d,
+  0xbe, 0x1f, 0x1c, 0x7c, 0xb1, 0x37, 0x10, 0x1a, 0x4e, 0x4d, 0x00, 0xb1, 0x02, 0x83, 0x10, 0x5e,
+  0xa8, 0x06, 0x3b, 0x7c, 0xb3, 0x8f, 0xb7, 0x3f, 0x24, 0x8a, 0x49, 0x12, 0x86, 0x47, 0x27, 0x04,
+  0x53, 0x70, 0x46, 0x79, 0x0c, 0x91, 0x49, 0x8f, 0x1b, 0x39, 0x12, 0x54, 0x1e, 0x6b, 0x3b, 0x72,
+  0xdc, 0xb2, 0x11, 0x6c, 0xb3, 0xb2, 0xc1, 0xf9, 0xd6, 0xc2, 0x57, 0x61, 0x0f, 0xdd, 0x2e, 0xaa,
+  0x33, 0x15, 0x2c, 0xe6, 0xec, 0x31, 0xac, 0x02, 0x6d, 0x66, 0x99, 0x0a, 0xa1, 0xa3, 0xf1, 0x89,
+  0x07, 0xf6, 0x42, 0x1c, 0x69, 0xec, 0x2a, 0x44, 0x03, 0xea, 0xc4, 0x55, 0x27, 0x06, 0x6f, 0x1c,
+  0xff, 0x29, 0x0c, 0x45, 0x1e, 0xc7, 0x36, 0x97, 0x06, 0x3d, 0x54, 0xf8, 0x44, 0xe3, 0x1c, 0x42,
+  0x65, 0x5a, 0xda, 0xbc, 0x33, 0x90, 0xb2, 0xc0, 0x9b, 0x55, 0x19, 0xeb, 0x41, 0x91, 0xf1, 0x7f,
+  0x66, 0x34, 0x7a, 0x65, 0xd4, 0x5e, 0x1f, 0x24, 0xb2, 0xb9, 0x22, 0xad, 0xb5, 0x99, 0x86, 0xbe,
+  0x2a, 0xa6, 0xbc, 0x0d, 0xb9, 0x61, 0x4d, 0x2a, 0x56, 0x31, 0x69, 0xba, 0xd5, 0xfa, 0x21, 0xde,
+  0xf2, 0xa3, 0xf1, 0x36, 0xe4, 0x64, 0x5c, 0xe6, 0x07, 0x9b, 0x9f, 0x04, 0xce, 0xf2, 0x36, 0x69,
+  0x85, 0xe9, 0x57, 0x10, 0xb4, 0x76, 0xcf, 0x29, 0x7f, 0x87, 0x85, 0x3b, 0x32, 0x35, 0xea, 0x13,
+  0x10, 0x6f, 0x5e, 0x98, 0x18, 0xa2, 0xec, 0x50, 0xc6, 0x20, 0xd3, 0x18, 0x41, 0xa5, 0x1c, 0xbc,
+  0xb7, 0x7d, 0xfb, 0x94, 0xab, 0x17, 0x62, 0x4b, 0xd1, 0xc4, 0x25, 0xd5, 0xdb, 0x71, 0xa1, 0x56,
+  0xf4, 0x17, 0x7f, 0xd7, 0x24, 0x75, 0x62, 0x9f, 0x4e, 0x27, 0xa4, 0xb1, 0x45, 0x50, 0x9a, 0x2d,
+  0x46, 0x81, 0xd5, 0x11, 0x14, 0x75, 0x5a, 0x94, 0x0c, 0xea, 0xc5, 0x0f, 0x36, 0x80, 0x7b, 0x54,
+  0x61, 0x4b, 0xd8, 0xb7, 0x74, 0xd7, 0xfe, 0x18, 0xfe, 0x2f, 0xc9, 0xb0, 0x5b, 0x0e, 0x22, 0x0f,
+  0x00, 0x00,
+};
+
+#endif // !_AUTOCONNECTSPA_H_
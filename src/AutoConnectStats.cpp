@@ -0,0 +1,506 @@
+/**
+ *  AutoConnectStats, AutoConnectLease and AutoConnectWear class implementation.
+ *  Records the connection results for each access point and estimates
+ *  the expected time to establish a connection from them. Also, caches
+ *  the lease of the last connection for the fast reconnect, and accounts
+ *  the writes to the flash by AutoConnect.
+ *  They are held in the RTC memory that survives the soft reset and the
+ *  deep sleep, so recording does not wear the flash.
+ *  @file   AutoConnectStats.cpp
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#include "AutoConnectStats.h"
+
+/**
+ * Identifier of the statistics store, "ACST".
+ */
+#define AC_STATS_IDENTIFIER 0x54534341UL
+
+/**
+ * Identifier of the lease cache, "ACLS".
+ */
+#define AC_LEASE_IDENTIFIER 0x534c4341UL
+
+/**
+ * Identifier of the wear accounting store, "ACWR".
+ */
+#define AC_WEAR_IDENTIFIER  0x52574341UL
+
+#if defined(ARDUINO_ARCH_ESP32)
+// ESP32 retains the area which is not initialized by the reset as
+// the RTC slow memory.
+RTC_NOINIT_ATTR static AutoConnectStatsStore_t _rtcStatsStore;
+RTC_NOINIT_ATTR static AutoConnectLease_t _rtcLease;
+RTC_NOINIT_ATTR static AutoConnectWearStore_t _rtcWearStore;
+#endif
+
+/**
+ *  Calculate CRC32 to verify the integrity of the store.
+ *  @param  data    Data to be verified.
+ *  @param  length  Length of the data.
+ *  @return CRC32
+ */
+static uint32_t _crc32(const void* data, size_t length) {
+  const uint8_t*  p = reinterpret_cast<const uint8_t*>(data);
+  uint32_t  crc = 0xffffffff;
+  while (length--) {
+    crc ^= *p++;
+    for (uint8_t i = 0; i < 8; i++)
+      crc = (crc >> 1) ^ (0xedb88320UL & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+/**
+ *  AutoConnectStats constructor.
+ *  Restores the statistics store from the RTC memory. If the store is
+ *  not valid, such as after a power-on, it starts with empty.
+ */
+AutoConnectStats::AutoConnectStats() {
+  if (!_restore())
+    clear();
+}
+
+/**
+ *  Clear all statistics.
+ */
+void AutoConnectStats::clear(void) {
+  memset(&_store, 0x00, sizeof(AutoConnectStatsStore_t));
+  _store.id = AC_STATS_IDENTIFIER;
+  _commit();
+}
+
+/**
+ *  Lists the channels on which the connections have been established,
+ *  in order of the most recent success.
+ *  @param  list  Buffer to store the channel numbers.
+ *  @param  size  Number of elements of the buffer.
+ *  @return Number of the channels listed.
+ */
+uint8_t AutoConnectStats::channels(uint8_t* list, const uint8_t size) const {
+  uint32_t  recent[AUTOCONNECT_STATS_ENTRIES];
+  uint8_t n = 0;
+
+  for (uint8_t i = 0; i < AUTOCONNECT_STATS_ENTRIES; i++) {
+    const AutoConnectStatsEntry_t&  st = _store.entry[i];
+    if (!st.key || !st.successes || !st.channel)
+      continue;
+    // The same channel takes the most recent success.
+    uint8_t c = 0;
+    while (c < n && list[c] != st.channel)
+      c++;
+    if (c < n) {
+      if (recent[c] >= st.lastSuccess)
+        continue;
+      memmove(&list[c], &list[c + 1], n - c - 1);
+      memmove(&recent[c], &recent[c + 1], (n - c - 1) * sizeof(uint32_t));
+      n--;
+    }
+    // Insert in descending order of the last success.
+    c = n;
+    while (c > 0 && recent[c - 1] < st.lastSuccess)
+      c--;
+    if (c < size) {
+      if (n == size)
+        n--;
+      memmove(&list[c + 1], &list[c], n - c);
+      memmove(&recent[c + 1], &recent[c], (n - c) * sizeof(uint32_t));
+      list[c] = st.channel;
+      recent[c] = st.lastSuccess;
+      n++;
+    }
+  }
+  return n;
+}
+
+/**
+ *  Returns the number of access points being recorded.
+ *  @return Number of entries.
+ */
+uint8_t AutoConnectStats::entries(void) const {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < AUTOCONNECT_STATS_ENTRIES; i++)
+    if (_store.entry[i].key)
+      n++;
+  return n;
+}
+
+/**
+ *  Estimates the time to connect to the access point. It takes into
+ *  account the smoothed time-to-IP and the success rate. Each failed
+ *  attempt costs the timeout, so the expected time is
+ *  mean + (1 - p) / p * timeout, p is the success rate with the
+ *  Laplace smoothing as (successes + 1) / (attempts + 2).
+ *  An access point that has no record is assumed to be half a chance.
+ *  @param  config  Station configuration of the access point.
+ *  @param  timeout Time limit for one attempt [ms].
+ *  @return Expected time to connect [ms].
+ */
+unsigned long AutoConnectStats::expect(const station_config_t& config, const unsigned long timeout) const {
+  uint32_t  attempts = 0;
+  uint32_t  successes = 0;
+  uint32_t  mean = AUTOCONNECT_STATS_PRIORTIME;
+
+  int8_t  n = _find(_key(config));
+  if (n >= 0) {
+    const AutoConnectStatsEntry_t&  st = _store.entry[n];
+    attempts = st.attempts;
+    successes = st.successes <= st.attempts ? st.successes : st.attempts;
+    if (successes)
+      mean = st.timeToIP;
+  }
+  uint64_t  penalty = (uint64_t)(timeout ? timeout : AUTOCONNECT_TIMEOUT) * (attempts - successes + 1) / (successes + 1);
+  uint64_t  expected = penalty + mean;
+  // ULONG_MAX is reserved for no candidate by the caller.
+  return expected < (uint64_t)(ULONG_MAX - 1) ? (unsigned long)expected : ULONG_MAX - 1;
+}
+
+/**
+ *  Load the statistics by the entry number.
+ *  @param  entry   Entry number to be loaded, counted except for empty.
+ *  @param  stats   Loaded statistics.
+ *  @return true    The statistics loaded.
+ *  @return false   The entry does not exist.
+ */
+bool AutoConnectStats::load(const uint8_t entry, AutoConnectStatsEntry_t* stats) const {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < AUTOCONNECT_STATS_ENTRIES; i++) {
+    if (_store.entry[i].key) {
+      if (n++ == entry) {
+        memcpy(stats, &_store.entry[i], sizeof(AutoConnectStatsEntry_t));
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ *  Load the statistics of the specified access point.
+ *  @param  config  Station configuration of the access point.
+ *  @param  stats   Loaded statistics.
+ *  @return true    The statistics loaded.
+ *  @return false   The access point has no record.
+ */
+bool AutoConnectStats::load(const station_config_t& config, AutoConnectStatsEntry_t* stats) const {
+  int8_t  n = _find(_key(config));
+  if (n >= 0) {
+    memcpy(stats, &_store.entry[n], sizeof(AutoConnectStatsEntry_t));
+    return true;
+  }
+  return false;
+}
+
+/**
+ *  Record a result of the connection attempt.
+ *  If the access point has no record, it takes over an empty entry or
+ *  the entry that has not been connected for the longest time.
+ *  @param  config      Station configuration of the attempted access point.
+ *  @param  established Whether the connection was established.
+ *  @param  elapsed     Time taken to obtain an IP address [ms].
+ *  @param  channel     WiFi channel of the established connection.
+ */
+void AutoConnectStats::record(const station_config_t& config, const bool established, const unsigned long elapsed, const uint8_t channel) {
+  uint32_t  key = _key(config);
+  if (!key)
+    return;
+
+  int8_t  n = _find(key);
+  if (n < 0) {
+    // Find a slot to be replaced.
+    n = 0;
+    for (uint8_t i = 0; i < AUTOCONNECT_STATS_ENTRIES; i++) {
+      if (!_store.entry[i].key) {
+        n = i;
+        break;
+      }
+      if (_store.entry[i].lastSuccess < _store.entry[n].lastSuccess)
+        n = i;
+    }
+    memset(&_store.entry[n], 0x00, sizeof(AutoConnectStatsEntry_t));
+    _store.entry[n].key = key;
+  }
+
+  AutoConnectStatsEntry_t&  st = _store.entry[n];
+  _store.sequence++;
+  // Fade out old results by halving the counts.
+  if (st.attempts >= AUTOCONNECT_STATS_WINDOW) {
+    st.attempts >>= 1;
+    st.successes >>= 1;
+  }
+  st.attempts++;
+  if (established) {
+    uint32_t  tm = elapsed < UINT32_MAX ? elapsed : UINT32_MAX;
+    // Smooth the time-to-IP with exponentially weighted moving average
+    // of alpha = 1/4.
+    if (!st.successes)
+      st.timeToIP = tm;
+    else
+      st.timeToIP = (uint32_t)(((uint64_t)st.timeToIP * 3 + tm) >> 2);
+    st.successes++;
+    st.lastSuccess = _store.sequence;
+    if (channel)
+      st.channel = channel;
+  }
+  AC_DBG("Stats %08" PRIx32 " %d/%d %" PRIu32 "ms\n", key, (int)st.successes, (int)st.attempts, st.timeToIP);
+  _commit();
+}
+
+/**
+ *  Generate the collation key of the access point. The key follows
+ *  the AUTOCONNECT_APKEY_SSID definition the same as the credential
+ *  collation, which is either BSSID or SSID.
+ *  @param  config  Station configuration of the access point.
+ *  @return FNV-1a hash of the key, 0 is an invalid key.
+ */
+uint32_t AutoConnectStats::_key(const station_config_t& config) {
+#if defined(AUTOCONNECT_APKEY_SSID)
+  const uint8_t*  src = config.ssid;
+  size_t  len = strnlen(reinterpret_cast<const char*>(config.ssid), sizeof(station_config_t::ssid));
+#else
+  const uint8_t*  src = config.bssid;
+  size_t  len = sizeof(station_config_t::bssid);
+#endif
+  uint8_t valid = 0;
+  uint32_t  hash = 2166136261UL;
+  while (len--) {
+    valid |= *src;
+    hash = (hash ^ *src++) * 16777619UL;
+  }
+  return valid ? (hash ? hash : 1) : 0;
+}
+
+/**
+ *  Find the entry of the specified key.
+ *  @param  key   Collation key.
+ *  @return Index of the entry, -1 if not found.
+ */
+int8_t AutoConnectStats::_find(const uint32_t key) const {
+  if (key) {
+    for (uint8_t i = 0; i < AUTOCONNECT_STATS_ENTRIES; i++)
+      if (_store.entry[i].key == key)
+        return i;
+  }
+  return -1;
+}
+
+/**
+ *  Write back the statistics to the RTC memory.
+ */
+void AutoConnectStats::_commit(void) {
+  _store.crc = _crc32(&_store, offsetof(AutoConnectStatsStore_t, crc));
+#if defined(ARDUINO_ARCH_ESP8266)
+  ESP.rtcUserMemoryWrite(AUTOCONNECT_STATS_RTCOFFSET, reinterpret_cast<uint32_t*>(&_store), sizeof(AutoConnectStatsStore_t));
+#elif defined(ARDUINO_ARCH_ESP32)
+  memcpy(&_rtcStatsStore, &_store, sizeof(AutoConnectStatsStore_t));
+#endif
+}
+
+/**
+ *  Read the statistics from the RTC memory and verify it.
+ *  @return true  Valid statistics restored.
+ */
+bool AutoConnectStats::_restore(void) {
+#if defined(ARDUINO_ARCH_ESP8266)
+  if (!ESP.rtcUserMemoryRead(AUTOCONNECT_STATS_RTCOFFSET, reinterpret_cast<uint32_t*>(&_store), sizeof(AutoConnectStatsStore_t)))
+    return false;
+#elif defined(ARDUINO_ARCH_ESP32)
+  memcpy(&_store, &_rtcStatsStore, sizeof(AutoConnectStatsStore_t));
+#endif
+  return _store.id == AC_STATS_IDENTIFIER && _store.crc == _crc32(&_store, offsetof(AutoConnectStatsStore_t, crc));
+}
+
+/**
+ *  Invalidate the lease cache.
+ */
+void AutoConnectLease::clear(void) {
+  AutoConnectLease_t  lease;
+  memset(&lease, 0x00, sizeof(AutoConnectLease_t));
+#if defined(ARDUINO_ARCH_ESP8266)
+  ESP.rtcUserMemoryWrite(AUTOCONNECT_LEASE_RTCOFFSET, reinterpret_cast<uint32_t*>(&lease), sizeof(AutoConnectLease_t));
+#elif defined(ARDUINO_ARCH_ESP32)
+  memcpy(&_rtcLease, &lease, sizeof(AutoConnectLease_t));
+#endif
+}
+
+/**
+ *  Load the lease cache from the RTC memory and verify it.
+ *  @param  lease   Loaded lease.
+ *  @return true    A valid lease loaded.
+ *  @return false   There is no valid lease.
+ */
+bool AutoConnectLease::load(AutoConnectLease_t* lease) const {
+#if defined(ARDUINO_ARCH_ESP8266)
+  if (!ESP.rtcUserMemoryRead(AUTOCONNECT_LEASE_RTCOFFSET, reinterpret_cast<uint32_t*>(lease), sizeof(AutoConnectLease_t)))
+    return false;
+#elif defined(ARDUINO_ARCH_ESP32)
+  memcpy(lease, &_rtcLease, sizeof(AutoConnectLease_t));
+#endif
+  return lease->ssidHash && lease->ip && lease->crc == (_crc32(lease, offsetof(AutoConnectLease_t, crc)) ^ AC_LEASE_IDENTIFIER);
+}
+
+/**
+ *  Hash the SSID to verify the saved credential that the lease refers.
+ *  @param  ssid    SSID, up to 32 bytes.
+ *  @return CRC32 of the SSID.
+ */
+uint32_t AutoConnectLease::hash(const uint8_t* ssid) {
+  return _crc32(ssid, strnlen(reinterpret_cast<const char*>(ssid), sizeof(station_config_t::ssid)));
+}
+
+/**
+ *  Save the lease cache to the RTC memory.
+ *  @param  lease   A lease to be saved, its crc will be updated.
+ */
+void AutoConnectLease::save(AutoConnectLease_t* lease) {
+  lease->crc = _crc32(lease, offsetof(AutoConnectLease_t, crc)) ^ AC_LEASE_IDENTIFIER;
+#if defined(ARDUINO_ARCH_ESP8266)
+  ESP.rtcUserMemoryWrite(AUTOCONNECT_LEASE_RTCOFFSET, reinterpret_cast<uint32_t*>(lease), sizeof(AutoConnectLease_t));
+#elif defined(ARDUINO_ARCH_ESP32)
+  memcpy(&_rtcLease, lease, sizeof(AutoConnectLease_t));
+#endif
+}
+
+AutoConnectWearStore_t  AutoConnectWear::_store;
+bool  AutoConnectWear::_restored = false;
+uint16_t  AutoConnectWear::_limit[AC_WEARSUBSYS_COUNT] = { 0 };
+uint32_t  AutoConnectWear::_window[AC_WEARSUBSYS_COUNT] = { 0 };
+unsigned long AutoConnectWear::_windowStart[AC_WEARSUBSYS_COUNT] = { 0 };
+uint16_t  AutoConnectWear::_windowCommits[AC_WEARSUBSYS_COUNT] = { 0 };
+
+/**
+ *  Determine whether the subsystem is allowed to commit now under the
+ *  rate limit. A refusal is counted.
+ *  @param  subsys  The subsystem about to commit.
+ *  @return true    The commit is allowed.
+ *  @return false   The commits in the current window reached the limit.
+ */
+bool AutoConnectWear::admit(const AC_WEARSUBSYS_t subsys) {
+  if (!_limit[subsys])
+    return true;
+  if (millis() - _windowStart[subsys] >= _window[subsys] * 1000UL) {
+    _windowStart[subsys] = millis();
+    _windowCommits[subsys] = 0;
+  }
+  if (_windowCommits[subsys] < _limit[subsys])
+    return true;
+  _restore();
+  if (_store.limited[subsys] < UINT16_MAX)
+    _store.limited[subsys]++;
+  _commit();
+  AC_DBG("Flash write of subsystem %d limited\n", (int)subsys);
+  return false;
+}
+
+/**
+ *  Reset the accounting.
+ */
+void AutoConnectWear::clear(void) {
+  memset(&_store, 0x00, sizeof(AutoConnectWearStore_t));
+  _store.id = AC_WEAR_IDENTIFIER;
+  _restored = true;
+  _commit();
+}
+
+/**
+ *  Count a commit. It also counts into the window of the rate limit.
+ *  @param  subsys  The subsystem that committed.
+ *  @param  region  The region committed.
+ */
+void AutoConnectWear::commit(const AC_WEARSUBSYS_t subsys, const AC_WEARREGION_t region) {
+  _restore();
+  _store.subsys[subsys].commits++;
+  if (region < AC_WEARREGION_COUNT)
+    _store.region[region].commits++;
+  _windowCommits[subsys]++;
+  _commit();
+}
+
+/**
+ *  Get the totals of the subsystem.
+ */
+const AutoConnectWearCount_t& AutoConnectWear::count(const AC_WEARSUBSYS_t subsys) {
+  _restore();
+  return _store.subsys[subsys];
+}
+
+/**
+ *  Get the totals of the region.
+ */
+const AutoConnectWearCount_t& AutoConnectWear::count(const AC_WEARREGION_t region) {
+  _restore();
+  return _store.region[region < AC_WEARREGION_COUNT ? region : 0];
+}
+
+/**
+ *  Get the number of the commits refused by the rate limit.
+ */
+uint16_t AutoConnectWear::limited(const AC_WEARSUBSYS_t subsys) {
+  _restore();
+  return _store.limited[subsys];
+}
+
+/**
+ *  Limit the commits of the subsystem.
+ *  @param  subsys  The subsystem to be limited.
+ *  @param  commits Commits allowed in the window, 0 is unlimited.
+ *  @param  window  Length of the window [s].
+ */
+void AutoConnectWear::limit(const AC_WEARSUBSYS_t subsys, const uint16_t commits, const uint32_t window) {
+  _limit[subsys] = commits;
+  _window[subsys] = window;
+  _windowStart[subsys] = millis();
+  _windowCommits[subsys] = 0;
+}
+
+/**
+ *  Count the bytes written and erased.
+ *  @param  subsys  The subsystem that wrote.
+ *  @param  region  The region written.
+ *  @param  bytes   Bytes written.
+ *  @param  erase   Bytes erased for the writing.
+ */
+void AutoConnectWear::write(const AC_WEARSUBSYS_t subsys, const AC_WEARREGION_t region, const size_t bytes, const size_t erase) {
+  _restore();
+  _store.subsys[subsys].bytes += bytes;
+  _store.subsys[subsys].erase += erase;
+  if (region < AC_WEARREGION_COUNT) {
+    _store.region[region].bytes += bytes;
+    _store.region[region].erase += erase;
+  }
+  _commit();
+}
+
+/**
+ *  Write back the accounting to the RTC memory.
+ */
+void AutoConnectWear::_commit(void) {
+  _store.crc = _crc32(&_store, offsetof(AutoConnectWearStore_t, crc));
+#if defined(ARDUINO_ARCH_ESP8266)
+  ESP.rtcUserMemoryWrite(AUTOCONNECT_WEAR_RTCOFFSET, reinterpret_cast<uint32_t*>(&_store), sizeof(AutoConnectWearStore_t));
+#elif defined(ARDUINO_ARCH_ESP32)
+  memcpy(&_rtcWearStore, &_store, sizeof(AutoConnectWearStore_t));
+#endif
+}
+
+/**
+ *  Restore the accounting from the RTC memory at the first use. It
+ *  starts from zero if the store is not valid.
+ */
+void AutoConnectWear::_restore(void) {
+  if (_restored)
+    return;
+  _restored = true;
+#if defined(ARDUINO_ARCH_ESP8266)
+  bool  rc = ESP.rtcUserMemoryRead(AUTOCONNECT_WEAR_RTCOFFSET, reinterpret_cast<uint32_t*>(&_store), sizeof(AutoConnectWearStore_t));
+#elif defined(ARDUINO_ARCH_ESP32)
+  memcpy(&_store, &_rtcWearStore, sizeof(AutoConnectWearStore_t));
+  bool  rc = true;
+#endif
+  if (!rc || _store.id != AC_WEAR_IDENTIFIER || _store.crc != _crc32(&_store, offsetof(AutoConnectWearStore_t, crc)))
+    clear();
+}
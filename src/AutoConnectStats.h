@@ -0,0 +1,215 @@
+/**
+ *  Declaration of AutoConnectStats, AutoConnectLease and AutoConnectWear class.
+ *  @file   AutoConnectStats.h
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTSTATS_H_
+#define _AUTOCONNECTSTATS_H_
+
+#include <limits.h>
+#include <Arduino.h>
+#include "AutoConnectDefs.h"
+#include "AutoConnectCredential.h"
+
+/**
+ * Number of access points whose connection statistics are retained.
+ * When the table is full, the entry that has not been connected for
+ * the longest time will be replaced.
+ */
+#ifndef AUTOCONNECT_STATS_ENTRIES
+#define AUTOCONNECT_STATS_ENTRIES   8
+#endif // !AUTOCONNECT_STATS_ENTRIES
+
+/**
+ * Offset of the statistics store in the RTC user memory, by 4 bytes
+ * block unit. It is valid only for ESP8266.
+ */
+#ifndef AUTOCONNECT_STATS_RTCOFFSET
+#define AUTOCONNECT_STATS_RTCOFFSET 64
+#endif // !AUTOCONNECT_STATS_RTCOFFSET
+
+/**
+ * Number of attempts to be evaluated. When the attempts exceed this
+ * window, the counts are halved so that old results fade out.
+ */
+#ifndef AUTOCONNECT_STATS_WINDOW
+#define AUTOCONNECT_STATS_WINDOW    32
+#endif // !AUTOCONNECT_STATS_WINDOW
+
+/**
+ * Assumed time-to-IP for an access point that has never been connected
+ * yet [ms].
+ */
+#ifndef AUTOCONNECT_STATS_PRIORTIME
+#define AUTOCONNECT_STATS_PRIORTIME 3000
+#endif // !AUTOCONNECT_STATS_PRIORTIME
+
+/** Connection statistics of an access point. */
+typedef struct {
+  uint32_t  key;          /**< Hashed collation key of the access point */
+  uint32_t  lastSuccess;  /**< Attempt sequence of the last success */
+  uint32_t  timeToIP;     /**< Smoothed time until IP acquired [ms] */
+  uint8_t   attempts;     /**< Number of connection attempts */
+  uint8_t   successes;    /**< Number of established connections */
+  uint8_t   channel;      /**< WiFi channel of the last success */
+  uint8_t   reserved;
+} AutoConnectStatsEntry_t;
+
+// The counts of an entry are 8 bits, the window must keep them from wrapping.
+static_assert(AUTOCONNECT_STATS_WINDOW > 0 && AUTOCONNECT_STATS_WINDOW <= UINT8_MAX, "AUTOCONNECT_STATS_WINDOW must be from 1 to 255");
+
+/** The image of the statistics store deployed to the RTC memory. */
+typedef struct {
+  uint32_t  id;           /**< Store identifier */
+  uint32_t  sequence;     /**< Total attempts as the logical clock */
+  AutoConnectStatsEntry_t entry[AUTOCONNECT_STATS_ENTRIES];
+  uint32_t  crc;          /**< CRC32 of the above */
+} AutoConnectStatsStore_t;
+
+class AutoConnectStats {
+ public:
+  AutoConnectStats();
+  ~AutoConnectStats() {}
+  void  clear(void);
+  uint8_t channels(uint8_t* list, const uint8_t size) const;
+  uint8_t entries(void) const;
+  unsigned long expect(const station_config_t& config, const unsigned long timeout) const;
+  bool  load(const uint8_t entry, AutoConnectStatsEntry_t* stats) const;
+  bool  load(const station_config_t& config, AutoConnectStatsEntry_t* stats) const;
+  void  record(const station_config_t& config, const bool established, const unsigned long elapsed, const uint8_t channel = 0);
+
+ protected:
+  static uint32_t _key(const station_config_t& config);
+  int8_t  _find(const uint32_t key) const;
+  void    _commit(void);
+  bool    _restore(void);
+  AutoConnectStatsStore_t _store; /**< Working copy of the store */
+};
+
+/**
+ * Offset of the lease cache in the RTC user memory, by 4 bytes block
+ * unit. It is valid only for ESP8266. The blocks from 0 to 31 are used
+ * by the OTA of ESP8266 core.
+ */
+#ifndef AUTOCONNECT_LEASE_RTCOFFSET
+#define AUTOCONNECT_LEASE_RTCOFFSET 32
+#endif // !AUTOCONNECT_LEASE_RTCOFFSET
+
+/**
+ * The cached lease for the fast reconnect. It is the configuration that
+ * established the last connection, includes the channel, BSSID and the
+ * IP addresses given by DHCP. The passphrase is not cached, the lease
+ * refers to the saved credential by the entry number and the hash of
+ * the SSID. It fits in 40 bytes.
+ */
+typedef struct {
+  uint32_t  ssidHash;     /**< CRC32 of the SSID of the credential */
+  uint8_t   bssid[6];     /**< BSSID */
+  uint8_t   channel;      /**< WiFi channel */
+  uint8_t   uses;         /**< Number of fast reconnections with this lease */
+  uint8_t   entry;        /**< Entry number of the saved credential */
+  uint8_t   reserved[3];  /**< Padding to the 4 bytes block */
+  uint32_t  ip;           /**< Station IP address */
+  uint32_t  gateway;      /**< Gateway address */
+  uint32_t  netmask;      /**< Subnet mask */
+  uint32_t  dns1;         /**< Primary DNS server */
+  uint32_t  dns2;         /**< Secondary DNS server */
+  uint32_t  crc;          /**< CRC32 of the above, with the identifier */
+} AutoConnectLease_t;
+
+class AutoConnectLease {
+ public:
+  AutoConnectLease() {}
+  ~AutoConnectLease() {}
+  void  clear(void);
+  bool  load(AutoConnectLease_t* lease) const;
+  void  save(AutoConnectLease_t* lease);
+  static uint32_t hash(const uint8_t* ssid);
+};
+
+/**
+ * Offset of the wear accounting store in the RTC user memory, by 4 bytes
+ * block unit. It is valid only for ESP8266, and the store occupies the
+ * blocks up to 127.
+ */
+#ifndef AUTOCONNECT_WEAR_RTCOFFSET
+#define AUTOCONNECT_WEAR_RTCOFFSET  100
+#endif // !AUTOCONNECT_WEAR_RTCOFFSET
+
+/**
+ * Size of the flash sector erased by an EEPROM commit [bytes].
+ */
+#ifndef AUTOCONNECT_WEAR_SECTOR
+#define AUTOCONNECT_WEAR_SECTOR     4096
+#endif // !AUTOCONNECT_WEAR_SECTOR
+
+/** Subsystems of AutoConnect that write to the flash. */
+typedef enum {
+  AC_WEARSUBSYS_CREDENTIAL,   /**< AutoConnectCredential */
+  AC_WEARSUBSYS_ELEMENT,      /**< AutoConnectAux::saveElement */
+  AC_WEARSUBSYS_UPLOAD,       /**< AutoConnectUploadFS and AutoConnectUploadSD */
+  AC_WEARSUBSYS_OTA,          /**< AutoConnectOTA */
+  AC_WEARSUBSYS_COUNT
+} AC_WEARSUBSYS_t;
+
+/** Regions of the flash written by the subsystems. */
+typedef enum {
+  AC_WEARREGION_EEPROM,       /**< EEPROM emulation sector */
+  AC_WEARREGION_NVS,          /**< NVS partition of ESP32 */
+  AC_WEARREGION_FS,           /**< File system */
+  AC_WEARREGION_APP,          /**< Application partition updated by OTA */
+  AC_WEARREGION_COUNT,
+  AC_WEARREGION_NONE = AC_WEARREGION_COUNT  /**< Not the onboard flash, such as SD */
+} AC_WEARREGION_t;
+
+/** Accumulated writes. */
+typedef struct {
+  uint32_t  commits;      /**< Number of the commits */
+  uint32_t  bytes;        /**< Bytes written */
+  uint32_t  erase;        /**< Bytes erased */
+} AutoConnectWearCount_t;
+
+/** The image of the wear accounting store deployed to the RTC memory. */
+typedef struct {
+  uint32_t  id;           /**< Store identifier */
+  AutoConnectWearCount_t  subsys[AC_WEARSUBSYS_COUNT];  /**< Totals by the subsystem */
+  AutoConnectWearCount_t  region[AC_WEARREGION_COUNT];  /**< Totals by the region */
+  uint16_t  limited[AC_WEARSUBSYS_COUNT]; /**< Commits refused by the rate limit */
+  uint32_t  crc;          /**< CRC32 of the above */
+} AutoConnectWearStore_t;
+
+#if defined(ARDUINO_ARCH_ESP8266)
+// The stores share the 128 blocks of the RTC user memory in the order of
+// the lease, the statistics and the wear accounting.
+static_assert(AUTOCONNECT_LEASE_RTCOFFSET + (sizeof(AutoConnectLease_t) + 3) / 4 <= AUTOCONNECT_STATS_RTCOFFSET, "The lease cache overlaps the statistics store in the RTC memory");
+static_assert(AUTOCONNECT_STATS_RTCOFFSET + (sizeof(AutoConnectStatsStore_t) + 3) / 4 <= AUTOCONNECT_WEAR_RTCOFFSET, "The statistics store overlaps the wear accounting store in the RTC memory");
+static_assert(AUTOCONNECT_WEAR_RTCOFFSET + (sizeof(AutoConnectWearStore_t) + 3) / 4 <= 128, "The wear accounting store exceeds the RTC user memory");
+#endif
+
+class AutoConnectWear {
+ public:
+  static bool admit(const AC_WEARSUBSYS_t subsys);
+  static void clear(void);
+  static void commit(const AC_WEARSUBSYS_t subsys, const AC_WEARREGION_t region);
+  static const AutoConnectWearCount_t&  count(const AC_WEARSUBSYS_t subsys);
+  static const AutoConnectWearCount_t&  count(const AC_WEARREGION_t region);
+  static uint16_t limited(const AC_WEARSUBSYS_t subsys);
+  static void limit(const AC_WEARSUBSYS_t subsys, const uint16_t commits, const uint32_t window);
+  static void write(const AC_WEARSUBSYS_t subsys, const AC_WEARREGION_t region, const size_t bytes, const size_t erase = 0);
+
+ protected:
+  static void _commit(void);
+  static void _restore(void);
+  static AutoConnectWearStore_t _store; /**< Working copy of the store */
+  static bool _restored;                /**< _store has been restored */
+  static uint16_t _limit[AC_WEARSUBSYS_COUNT];        /**< Commits allowed in the window */
+  static uint32_t _window[AC_WEARSUBSYS_COUNT];       /**< Rate limit window [s] */
+  static unsigned long  _windowStart[AC_WEARSUBSYS_COUNT];  /**< Start of the current window */
+  static uint16_t _windowCommits[AC_WEARSUBSYS_COUNT];  /**< Commits in the current window */
+};
+
+#endif // !_AUTOCONNECTSTATS_H_
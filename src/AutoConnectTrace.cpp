@@ -0,0 +1,134 @@
+/**
+ *  AutoConnectTrace class implementation.
+ *  The recording is inlined in the header, here are the readers which
+ *  format or dump the records apart from the event sites.
+ *  @file   AutoConnectTrace.cpp
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#include "AutoConnectDefs.h"
+
+#ifdef AUTOCONNECT_USE_TRACE
+
+#include "AutoConnectTrace.h"
+
+AC_TRACEREC_t AutoConnectTrace::_ring[AUTOCONNECT_TRACE_SIZE];
+std::atomic<uint32_t> AutoConnectTrace::_head(0);
+uint32_t  AutoConnectTrace::_tail = 0;
+uint32_t  AutoConnectTrace::_lost = 0;
+
+/**
+ *  Event names in the order of AC_TRACEID_t, index 0 is unused.
+ */
+static const char* const _traceNames[] = {
+  "", "BEGINSTATE", "WAITSTART", "WAITEND", "SETTLE", "SCANSTART", "SCANEND", "WIFIEVENT",
+  "RECONNECT", "REQUEST", "DNS", "PORTALSTART", "PORTALSTOP", "COMMIT", "CONNECT", "DISCONNECT",
+  "CLASSIFY", "LEASE"
+};
+
+/**
+ *  FNV-1a hash to identify the string such as URI by a record argument.
+ *  @param  str   A string to be hashed.
+ *  @return The hash value.
+ */
+uint32_t AutoConnectTrace::hash(const char* str) {
+  uint32_t  h = 2166136261UL;
+  while (*str) {
+    h ^= static_cast<uint8_t>(*str++);
+    h *= 16777619UL;
+  }
+  return h;
+}
+
+/**
+ *  Format the records not drained yet in text and output them. It is
+ *  called at idle so that the output does not disturb the timing of
+ *  the events.
+ *  @param  out     Output destination.
+ *  @param  budget  Maximum number of the records to be output.
+ *  @return Number of the records output.
+ */
+size_t AutoConnectTrace::drain(Print& out, const size_t budget) {
+  uint32_t  head = _head.load(std::memory_order_acquire);
+  if (head - _tail > AUTOCONNECT_TRACE_SIZE) {
+    _lost += head - _tail - AUTOCONNECT_TRACE_SIZE;
+    _tail = head - AUTOCONNECT_TRACE_SIZE;
+  }
+  size_t  n = 0;
+  char  line[64];
+  while (_tail != head && n < budget) {
+    format(line, sizeof(line), _ring[_tail++ % AUTOCONNECT_TRACE_SIZE]);
+    out.print(F("[AC] "));
+    out.println(line);
+    n++;
+  }
+  return n;
+}
+
+/**
+ *  Number of the records held in the ring.
+ */
+uint16_t AutoConnectTrace::available(void) {
+  uint32_t  head = _head.load(std::memory_order_acquire);
+  return head < AUTOCONNECT_TRACE_SIZE ? head : AUTOCONNECT_TRACE_SIZE;
+}
+
+/**
+ *  Output the latest records in binary as AC_TRACEHEADER_t followed by
+ *  the records from the oldest. The drain position is not affected.
+ *  @param  out     Output destination.
+ *  @param  count   Number of the records, obtained by available.
+ *  @return Number of the bytes output.
+ */
+size_t AutoConnectTrace::dump(Print& out, const uint16_t count) {
+  AC_TRACEHEADER_t  header;
+  memcpy(header.magic, "ACTR", sizeof(header.magic));
+  header.version = 1;
+  header.recSize = sizeof(AC_TRACEREC_t);
+  header.count = count;
+  header.head = _head.load(std::memory_order_acquire);
+  header.now = micros();
+  size_t  sz = out.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+  for (uint32_t seq = header.head - count; seq != header.head; seq++)
+    sz += out.write(reinterpret_cast<const uint8_t*>(&_ring[seq % AUTOCONNECT_TRACE_SIZE]), sizeof(AC_TRACEREC_t));
+  return sz;
+}
+
+/**
+ *  Format a record in text.
+ *  @param  buffer  A buffer to store the text.
+ *  @param  size    Size of the buffer.
+ *  @param  rec     A record.
+ *  @return Length of the text.
+ */
+size_t AutoConnectTrace::format(char* buffer, const size_t size, const AC_TRACEREC_t& rec) {
+  int len;
+  if (rec.id && rec.id < sizeof(_traceNames) / sizeof(_traceNames[0]))
+    len = snprintf_P(buffer, size, PSTR("%10lu %5u %-11s %ld %ld"), static_cast<unsigned long>(rec.time), static_cast<unsigned int>(rec.seq), _traceNames[rec.id], static_cast<long>(rec.a), static_cast<long>(rec.b));
+  else
+    len = snprintf_P(buffer, size, PSTR("%10lu %5u #%-10u %ld %ld"), static_cast<unsigned long>(rec.time), static_cast<unsigned int>(rec.seq), static_cast<unsigned int>(rec.id), static_cast<long>(rec.a), static_cast<long>(rec.b));
+  return len < 0 ? 0 : static_cast<size_t>(len);
+}
+
+/**
+ *  Format the records held in the ring in text. The drain position is
+ *  not affected.
+ */
+String AutoConnectTrace::toText(void) {
+  uint16_t  count = available();
+  uint32_t  head = _head.load(std::memory_order_acquire);
+  String  text;
+  text.reserve(count * 48);
+  char  line[64];
+  for (uint32_t seq = head - count; seq != head; seq++) {
+    format(line, sizeof(line), _ring[seq % AUTOCONNECT_TRACE_SIZE]);
+    text += line;
+    text += '\n';
+  }
+  return text;
+}
+
+#endif // !AUTOCONNECT_USE_TRACE
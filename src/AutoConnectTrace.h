@@ -0,0 +1,136 @@
+/**
+ *  Declaration of AutoConnectTrace class.
+ *  Records the compact binary events into a RAM ring buffer instead of
+ *  formatting the debug messages at the event site. The formatting is
+ *  deferred to the serial drain at idle, the dump endpoint or the host
+ *  side decoder, actrace.py.
+ *  @file   AutoConnectTrace.h
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTTRACE_H_
+#define _AUTOCONNECTTRACE_H_
+
+#include <stdint.h>
+#include "AutoConnectDefs.h"
+
+#ifdef AUTOCONNECT_USE_TRACE
+#define AC_TRACE(id, a, b)  AutoConnectTrace::record(id, static_cast<int32_t>(a), static_cast<int32_t>(b))
+#else
+#define AC_TRACE(id, a, b)  do {(void)0;} while (0)
+#endif // !AUTOCONNECT_USE_TRACE
+
+// The debug messages on the timing-critical paths, such as the waits for
+// the connection, the classification of the requests and the pass of
+// handleRequest, give way to the trace records. Their output to the
+// serial would disturb the timing that the trace measures.
+#ifdef AUTOCONNECT_USE_TRACE
+#define AC_TDBG(...)        do {(void)0;} while (0)
+#define AC_TDBG_DUMB(...)   do {(void)0;} while (0)
+#else
+#define AC_TDBG(...)        AC_DBG(__VA_ARGS__)
+#define AC_TDBG_DUMB(...)   AC_DBG_DUMB(__VA_ARGS__)
+#endif // !AUTOCONNECT_USE_TRACE
+
+#ifdef AUTOCONNECT_USE_TRACE
+
+#include <atomic>
+#include <Arduino.h>
+
+/**
+ * Event IDs. The decoder reads the names from this enumeration, keep
+ * the form of AC_TRACEID_name = value. The IDs from AC_TRACEID_USER are
+ * free for the Sketch.
+ */
+typedef enum {
+  AC_TRACEID_BEGINSTATE = 1,  /**< a:state */
+  AC_TRACEID_WAITSTART = 2,   /**< a:timeout [ms] */
+  AC_TRACEID_WAITEND = 3,     /**< a:satisfied, b:elapsed [ms] */
+  AC_TRACEID_SETTLE = 4,      /**< a:wl_status_t, b:elapsed [ms] */
+  AC_TRACEID_SCANSTART = 5,   /**< a:channel, b:async */
+  AC_TRACEID_SCANEND = 6,     /**< a:networks found or WIFI_SCAN_FAILED */
+  AC_TRACEID_WIFIEVENT = 7,   /**< a:AC_WIFIEVENT_t, b:reason */
+  AC_TRACEID_RECONNECT = 8,   /**< a:result */
+  AC_TRACEID_REQUEST = 9,     /**< a:HTTPMethod, b:FNV-1a hash of the URI */
+  AC_TRACEID_DNS = 10,        /**< a:queries processed */
+  AC_TRACEID_PORTALSTART = 11,  /**< a:SoftAP IP */
+  AC_TRACEID_PORTALSTOP = 12, /**< none */
+  AC_TRACEID_COMMIT = 13,     /**< a:saved */
+  AC_TRACEID_CONNECT = 14,    /**< a:channel, b:FNV-1a hash of the SSID */
+  AC_TRACEID_DISCONNECT = 15, /**< a:retainPortal */
+  AC_TRACEID_CLASSIFY = 16,   /**< a:AC_TRACECLASSIFY_t */
+  AC_TRACEID_LEASE = 17,      /**< a:1 cached, 0 not cached, -1 discarded, b:credential entry */
+  AC_TRACEID_USER = 0x8000
+} AC_TRACEID_t;
+
+/** Results of the request classification, the argument of AC_TRACEID_CLASSIFY */
+typedef enum {
+  AC_TRACECLASSIFY_IGNORED,     /**< Not an AutoConnect page */
+  AC_TRACECLASSIFY_GENERATED,   /**< The page was built */
+  AC_TRACECLASSIFY_CACHED,      /**< The page built previously was reused */
+  AC_TRACECLASSIFY_STREAMED,    /**< Streamed without the page */
+  AC_TRACECLASSIFY_REFUSED,     /**< Refused in the low memory mode */
+  AC_TRACECLASSIFY_REDIRECTED   /**< Redirected in the low memory mode */
+} AC_TRACECLASSIFY_t;
+
+/** A record of the event, 16 bytes in little endian */
+typedef struct {
+  uint32_t  time;     /**< micros() at the event */
+  uint16_t  id;       /**< AC_TRACEID_t */
+  uint16_t  seq;      /**< Lower 16 bits of the sequence number */
+  int32_t   a;        /**< Argument */
+  int32_t   b;        /**< Argument */
+} AC_TRACEREC_t;
+
+/** Header of the dump, followed by the records */
+typedef struct {
+  char      magic[4]; /**< "ACTR" */
+  uint8_t   version;  /**< Format version */
+  uint8_t   recSize;  /**< sizeof(AC_TRACEREC_t) */
+  uint16_t  count;    /**< Number of the records */
+  uint32_t  head;     /**< Sequence number of the next record */
+  uint32_t  now;      /**< micros() at the dump */
+} AC_TRACEHEADER_t;
+
+class AutoConnectTrace {
+ public:
+  /**
+   * Record an event. It is a few stores into the ring, the oldest
+   * record is overwritten when the ring is full. The record is not
+   * published atomically, so call it from the task that runs
+   * handleRequest, never from the WiFi event handler or an ISR.
+   */
+  static inline void record(const uint16_t id, const int32_t a, const int32_t b) {
+#if defined(ARDUINO_ARCH_ESP32)
+    uint32_t  seq = _head.fetch_add(1, std::memory_order_relaxed);
+#else
+    uint32_t  seq = _head.load(std::memory_order_relaxed);
+    _head.store(seq + 1, std::memory_order_relaxed);
+#endif
+    AC_TRACEREC_t&  rec = _ring[seq % AUTOCONNECT_TRACE_SIZE];
+    rec.time = micros();
+    rec.id = id;
+    rec.seq = static_cast<uint16_t>(seq);
+    rec.a = a;
+    rec.b = b;
+  }
+  static uint32_t hash(const char* str);
+  static size_t   drain(Print& out, const size_t budget);
+  static size_t   dump(Print& out, const uint16_t count);
+  static uint16_t available(void);
+  static size_t   format(char* buffer, const size_t size, const AC_TRACEREC_t& rec);
+  static String   toText(void);
+  static uint32_t lost(void) { return _lost; }
+
+ protected:
+  static AC_TRACEREC_t  _ring[AUTOCONNECT_TRACE_SIZE];  /**< Ring buffer */
+  static std::atomic<uint32_t>  _head;  /**< Sequence number of the next record */
+  static uint32_t _tail;              /**< Sequence number of the next record to be drained */
+  static uint32_t _lost;              /**< Records overwritten before drained */
+};
+
+#endif // !AUTOCONNECT_USE_TRACE
+#endif // !_AUTOCONNECTTRACE_H_
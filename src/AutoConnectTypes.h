@@ -25,9 +25,46 @@ typedef enum AC_ONBOOTURI {
 /** WiFi connection principle, it specifies the order of WiFi connecting with saved credentials. */
 typedef enum AC_PRINCIPLE {
   AC_PRINCIPLE_RECENT,
-  AC_PRINCIPLE_RSSI
+  AC_PRINCIPLE_RSSI,
+  AC_PRINCIPLE_LATENCY
 } AC_PRINCIPLE_t;
 
+/**< Progress of AutoConnect::beginAsync, the states from AC_BEGINSTATE_SETUP
+ * to AC_BEGINSTATE_PORTALCONNECT are in progress. */
+typedef enum AC_BEGINSTATE {
+  AC_BEGINSTATE_IDLE,           // beginAsync is not in use.
+  AC_BEGINSTATE_SETUP,          // Waiting for the STA mode to be ready.
+  AC_BEGINSTATE_SCAN,           // Scanning to choose a saved credential.
+  AC_BEGINSTATE_CONNECT,        // Waiting for the 1st-WiFi.begin to establish.
+  AC_BEGINSTATE_RESCAN,         // Scanning for the autoReconnect.
+  AC_BEGINSTATE_RECONNECT,      // Waiting for the autoReconnect to establish.
+  AC_BEGINSTATE_SOFTAP,         // Starting SoftAP for the captive portal.
+  AC_BEGINSTATE_PORTAL,         // The captive portal is available.
+  AC_BEGINSTATE_PORTALCONNECT,  // Waiting for the connection requested from the portal.
+  AC_BEGINSTATE_CONNECTED,      // WiFi connection established.
+  AC_BEGINSTATE_FAILED          // Not connected and the captive portal is over.
+} AC_BEGINSTATE_t;
+
+/**< Phases of AutoConnect::begin and beginAsync measured by AC_BOOTPROFILE_t. */
+typedef enum AC_BOOTPHASE {
+  AC_BOOTPHASE_PREPARE,         // Switching to the STA mode.
+  AC_BOOTPHASE_CREDENTIAL,      // Loading the credentials from EEPROM/NVS or the RTC memory.
+  AC_BOOTPHASE_SCAN,            // Scanning for the saved access points.
+  AC_BOOTPHASE_CONNECT,         // WiFi.begin and waiting for the connection.
+  AC_BOOTPHASE_SOFTAP,          // Starting SoftAP for the captive portal.
+  AC_BOOTPHASE_WEBSERVER,       // Starting the web server and registering the pages.
+  AC_BOOTPHASE_DNS,             // Starting the DNS server.
+  AC_BOOTPHASE_COUNT
+} AC_BOOTPHASE_t;
+
+/**< Time profile of the latest AutoConnect::begin or beginAsync. */
+typedef struct AC_BOOTPROFILE {
+  uint32_t  phase[AC_BOOTPHASE_COUNT];  // Time spent in each phase [us].
+  uint32_t  toConnected;        // From the beginning until connected [us], 0 if not connected.
+  uint32_t  toPortal;           // From the beginning until the portal is available [us], 0 if not opened.
+  bool      async;              // Profiled with beginAsync.
+} AC_BOOTPROFILE_t;
+
 /**< An enumerated type of the designated menu items. */
 typedef enum AC_MENUITEM {
   AC_MENUITEM_NONE       = 0x0000,
@@ -279,6 +279,7 @@ AC_UPDATESTATUS_t AutoConnectUpdateAct::update(void) {
     AC_DBG("An update has not specified");
     _status = UPDATE_NOAVAIL;
   }
+  AC_EVENTS(AutoConnectEvents::end(PSTR("update")));
   return _status;
 }
 
@@ -339,6 +340,7 @@ void AutoConnectUpdateAct::_buildAux(AutoConnectAux* aux, const AutoConnectUpdat
 void AutoConnectUpdateAct::_inProgress(size_t amount, size_t size) {
   _amount = amount;
   _binSize = size;
+  AC_EVENTS(AutoConnectEvents::progress(PSTR("update"), amount, size));
   _webServer->handleClient();
 }
 
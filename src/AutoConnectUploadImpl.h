@@ -42,6 +42,7 @@ typedef SDFile        SDFileT;
 
 #include "AutoConnectDefs.h"
 #include "AutoConnectUpload.h"
+#include "AutoConnectStats.h"
 
 namespace AutoConnectUtil {
 AC_HAS_FUNC(end);
@@ -104,16 +105,21 @@ class AutoConnectUploadFS : public AutoConnectUploadHandler {
   }
 
   size_t  _write(const uint8_t* buf, const size_t size) override {
-    if (_file)
-      return _file.write(buf, size);
+    if (_file) {
+      size_t  wsz = _file.write(buf, size);
+      AutoConnectWear::write(AC_WEARSUBSYS_UPLOAD, AC_WEARREGION_FS, wsz);
+      return wsz;
+    }
     else
       return -1;
   }
 
   void  _close(const HTTPUploadStatus status) override {
     AC_UNUSED(status);
-    if (_file)
+    if (_file) {
       _file.close();
+      AutoConnectWear::commit(AC_WEARSUBSYS_UPLOAD, AC_WEARREGION_FS);
+    }
     _media->end();
   }
 
@@ -204,16 +210,21 @@ class AutoConnectUploadSD : public AutoConnectUploadHandler {
   }
 
   size_t  _write(const uint8_t* buf, const size_t size) override {
-    if (_file)
-      return _file.write(buf, size);
+    if (_file) {
+      size_t  wsz = _file.write(buf, size);
+      AutoConnectWear::write(AC_WEARSUBSYS_UPLOAD, AC_WEARREGION_NONE, wsz);
+      return wsz;
+    }
     else
       return -1;
   }
 
   void  _close(const HTTPUploadStatus status) override {
     AC_UNUSED(status);
-    if (_file)
+    if (_file) {
       _file.close();
+      AutoConnectWear::commit(AC_WEARSUBSYS_UPLOAD, AC_WEARREGION_NONE);
+    }
     AutoConnectUtil::end<SDClassT>(_media);
   }
 
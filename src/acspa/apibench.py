@@ -0,0 +1,156 @@
+#!python3.*
+
+"""portal interaction comparator.
+
+Issues the same interactions to the HTML pages of the portal and to the
+JSON API, and reports the bytes on the wire and the time to the last
+byte per interaction of both paths. The time to the last byte includes
+the rendering on the ESP module, so its difference between the paths is
+the approximation of the CPU time spent for the rendering.
+
+With --watch, it also compares the polling of a progress endpoint with
+the subscription to the event stream over the same period.
+"""
+
+import argparse
+import http.client
+import json
+import logging
+import socket
+import statistics
+import sys
+import time
+
+# Interactions, the HTML page and its counterpart of the JSON API.
+INTERACTIONS = [
+    ('status', '/_ac', '/_ac/api/status'),
+    ('scan', '/_ac/config', '/_ac/api/scan'),
+    ('credentials', '/_ac/open', '/_ac/api/credentials'),
+]
+
+
+def fetch(host, uri, timeout):
+    conn = http.client.HTTPConnection(host, timeout=timeout)
+    start = time.monotonic()
+    try:
+        conn.request('GET', uri, headers={'Accept-Encoding': 'gzip'})
+        res = conn.getresponse()
+        body = res.read()
+        elapsed = time.monotonic() - start
+        # Status line and the headers are counted as sent.
+        head = len('HTTP/1.1 %d %s\r\n' % (res.status, res.reason))
+        head += sum(len('%s: %s\r\n' % h) for h in res.getheaders()) + 2
+        return res.status, head + len(body), elapsed
+    finally:
+        conn.close()
+
+
+def measure(host, uri, count, timeout, logger):
+    sizes = []
+    times = []
+    for _ in range(count):
+        try:
+            status, size, elapsed = fetch(host, uri, timeout)
+        except (OSError, http.client.HTTPException) as e:
+            logger.warning('%s: %s', uri, e)
+            continue
+        if status != 200:
+            logger.warning('%s: status %d', uri, status)
+            continue
+        sizes.append(size)
+        times.append(elapsed * 1000)
+    if not sizes:
+        return None
+    return {'uri': uri, 'bytes': int(statistics.median(sizes)), 'ms': round(statistics.median(times), 1), 'samples': len(sizes)}
+
+
+def poll(host, uri, period, interval, timeout, logger):
+    requests = 0
+    size = 0
+    busy = 0.0
+    end = time.monotonic() + period
+    while time.monotonic() < end:
+        try:
+            _, wire, elapsed = fetch(host, uri, timeout)
+        except (OSError, http.client.HTTPException) as e:
+            logger.warning('%s: %s', uri, e)
+        else:
+            requests += 1
+            size += wire
+            busy += elapsed
+        time.sleep(interval)
+    return {'uri': uri, 'requests': requests, 'bytes': size, 'ms': round(busy * 1000, 1)}
+
+
+def subscribe(host, uri, period, logger):
+    # One request holds the response, the events are counted as they come.
+    events = 0
+    size = 0
+    end = time.monotonic() + period
+    try:
+        with socket.create_connection((host, 80), timeout=period) as sock:
+            sock.sendall(('GET %s HTTP/1.1\r\nHost: %s\r\nAccept: text/event-stream\r\n\r\n' % (uri, host)).encode())
+            while time.monotonic() < end:
+                sock.settimeout(max(end - time.monotonic(), 0.01))
+                try:
+                    data = sock.recv(1024)
+                except socket.timeout:
+                    break
+                if not data:
+                    break
+                size += len(data)
+                events += data.count(b'\nevent: ') + data.startswith(b'event: ')
+    except OSError as e:
+        logger.warning('%s: %s', uri, e)
+    return {'uri': uri, 'requests': 1, 'bytes': size, 'events': events}
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Compare the HTML pages and the JSON API of AutoConnect per interaction')
+    parser.add_argument('--host', '-a', action='store', default='172.217.28.1',
+                        help='IP address of the portal')
+    parser.add_argument('--count', '-c', action='store', type=int, default=10,
+                        help='Number of the requests per interaction')
+    parser.add_argument('--timeout', action='store', type=float, default=10.0,
+                        help='Timeout of each request [s]')
+    parser.add_argument('--watch', '-w', action='store', type=float, default=0,
+                        help='Period to compare the polling with the event stream [s], 0 skips')
+    parser.add_argument('--poll', action='store', default='/_ac/update_progress',
+                        help='URI of the endpoint polled for the comparison with the event stream')
+    parser.add_argument('--interval', action='store', type=float, default=0.4,
+                        help='Interval of the polling [s]')
+    parser.add_argument('--json', '-j', action='store', default=None,
+                        help='Output the report to the file in JSON')
+    parser.add_argument('--log', '-l', action='store', default='INFO',
+                        help='Logging level')
+    args = parser.parse_args()
+    loglevel = getattr(logging, args.log.upper(), None)
+    if not isinstance(loglevel, int):
+        raise ValueError('Invalid log level: %s' % args.log)
+    logging.basicConfig(level=loglevel)
+    logger = logging.getLogger(__name__)
+
+    report = {}
+    print('%-12s %10s %10s %10s %10s' % ('interaction', 'html[B]', 'json[B]', 'html[ms]', 'json[ms]'))
+    for name, page, api in INTERACTIONS:
+        html = measure(args.host, page, args.count, args.timeout, logger)
+        js = measure(args.host, api, args.count, args.timeout, logger)
+        report[name] = {'html': html, 'json': js}
+        print('%-12s %10s %10s %10s %10s' % (
+            name,
+            html['bytes'] if html else '-', js['bytes'] if js else '-',
+            html['ms'] if html else '-', js['ms'] if js else '-'))
+
+    if args.watch > 0:
+        polled = poll(args.host, args.poll, args.watch, args.interval, args.timeout, logger)
+        pushed = subscribe(args.host, '/_ac/events', args.watch, logger)
+        report['watch'] = {'poll': polled, 'events': pushed}
+        print('%-12s %10s %10s %10s' % ('watch', 'requests', 'bytes', 'busy[ms]'))
+        print('%-12s %10d %10d %10s' % ('poll', polled['requests'], polled['bytes'], polled['ms']))
+        print('%-12s %10d %10d %10s' % ('events', pushed['requests'], pushed['bytes'], '-'))
+
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(report, f, indent=2)
+    if not all(report[name]['html'] and report[name]['json'] for name, _, _ in INTERACTIONS):
+        sys.exit(1)
@@ -0,0 +1,77 @@
+#!python3.*
+
+"""single-page front end generator.
+
+Compresses the single-page front end of the JSON API with gzip and
+generates AutoConnectSPA.h that holds it as the byte array in PROGMEM,
+which AutoConnect serves at /_ac/app with AUTOCONNECT_USE_SPA.
+"""
+
+import argparse
+import gzip
+import logging
+import os
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+PROLOGUE = '''/**
+ *  Precompressed single-page front end of the AutoConnect JSON API.
+ *  Generated by acspa/mkspa.py from acspa/%s, do not edit.
+ *  @file   AutoConnectSPA.h
+ *  @author hieromon@gmail.com
+ *  @version    1.2.2
+ *  @date   2020-12-18
+ *  @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTSPA_H_
+#define _AUTOCONNECTSPA_H_
+
+#include <Arduino.h>
+
+// Original size %d bytes, gzip compressed %d bytes
+static const uint8_t _autoconnectSPA[] PROGMEM = {
+'''
+
+EPILOGUE = '''};
+
+#endif // !_AUTOCONNECTSPA_H_
+'''
+
+
+def minify(html):
+    # Only the indentation and the line breaks are removed, the content
+    # is compressed by gzip anyway.
+    return ''.join(line.strip() for line in html.splitlines()).encode('utf-8')
+
+
+def generate(source, header):
+    with open(source, encoding='utf-8') as f:
+        content = minify(f.read())
+    # The fixed mtime makes the output reproducible.
+    compressed = gzip.compress(content, compresslevel=9, mtime=0)
+    with open(header, 'w', newline='\n') as f:
+        f.write(PROLOGUE % (os.path.basename(source), len(content), len(compressed)))
+        for i in range(0, len(compressed), 16):
+            f.write('  ' + ', '.join('0x%02x' % b for b in compressed[i:i + 16]) + ',\n')
+        f.write(EPILOGUE)
+    return len(content), len(compressed)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Generate AutoConnectSPA.h from the single-page front end')
+    parser.add_argument('source', nargs='?', default=os.path.join(HERE, 'index.html'),
+                        help='HTML of the single-page front end')
+    parser.add_argument('--output', '-o', action='store', default=os.path.join(HERE, '..', 'AutoConnectSPA.h'),
+                        help='Header file to be generated')
+    parser.add_argument('--log', '-l', action='store', default='INFO',
+                        help='Logging level')
+    args = parser.parse_args()
+    loglevel = getattr(logging, args.log.upper(), None)
+    if not isinstance(loglevel, int):
+        raise ValueError('Invalid log level: %s' % args.log)
+    logging.basicConfig(level=loglevel)
+    logger = logging.getLogger(__name__)
+
+    original, compressed = generate(args.source, args.output)
+    logger.info('%s generated, %d bytes compressed to %d bytes', args.output, original, compressed)
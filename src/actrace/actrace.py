@@ -0,0 +1,127 @@
+#!python3.*
+
+"""trace decoder.
+
+Decodes the binary dump of the AutoConnect trace ring buffer served at
+/_ac/trace with AUTOCONNECT_USE_TRACE, and prints the events in text.
+The event names are read from AutoConnectTrace.h.
+"""
+
+import argparse
+import ipaddress
+import logging
+import os
+import re
+import struct
+import sys
+import urllib.request
+
+HEADER = struct.Struct('<4sBBHII')
+RECORD = struct.Struct('<IHHii')
+
+# URIs of AutoConnect to resolve the hash of the REQUEST event.
+URIS = [
+    '/_ac', '/_ac/config', '/_ac/connect', '/_ac/open', '/_ac/disc',
+    '/_ac/reset', '/_ac/result', '/_ac/success', '/_ac/fail', '/_ac/update',
+    '/_ac/metrics', '/_ac/trace', '/_ac/app', '/_ac/api/status', '/_ac/api/scan',
+    '/_ac/api/credentials', '/_ac/api/connect', '/_ac/api/delete',
+    '/_ac/api/reset', '/_ac/events', '/generate_204', '/hotspot-detect.html',
+    '/ncsi.txt', '/connecttest.txt', '/success.txt', '/canonical.html', '/',
+]
+
+WIFIEVENTS = ['GOTIP', 'DISCONNECTED', 'RECONNECT']
+
+TRACEID = re.compile(r'AC_TRACEID_(\w+)\s*=\s*(0x[0-9A-Fa-f]+|\d+)')
+
+
+def load_names(header):
+    names = {}
+    with open(header) as f:
+        for name, value in TRACEID.findall(f.read()):
+            names[int(value, 0)] = name
+    return names
+
+
+def fnv1a(s):
+    h = 2166136261
+    for c in s.encode():
+        h = ((h ^ c) * 16777619) & 0xffffffff
+    return h
+
+
+def signed(v):
+    return v - 0x100000000 if v & 0x80000000 else v
+
+
+def describe(name, a, b, uris):
+    if name == 'REQUEST':
+        return 'method=%d uri=%s' % (a, uris.get(b & 0xffffffff, '#%08x' % (b & 0xffffffff)))
+    if name == 'WIFIEVENT':
+        event = WIFIEVENTS[a] if 0 <= a < len(WIFIEVENTS) else str(a)
+        return 'event=%s reason=%d' % (event, b)
+    if name == 'PORTALSTART':
+        return 'ip=%s' % ipaddress.IPv4Address(struct.pack('<i', a))
+    return '%d %d' % (a, b)
+
+
+def decode(data, names, uris):
+    magic, version, size, count, head, now = HEADER.unpack_from(data, 0)
+    if magic != b'ACTR':
+        raise ValueError('Not a trace dump')
+    if version != 1 or size != RECORD.size:
+        raise ValueError('Unsupported format version:%d, record size:%d' % (version, size))
+    events = []
+    for n in range(count):
+        time, id, seq, a, b = RECORD.unpack_from(data, HEADER.size + n * size)
+        events.append((time, id, seq, a, b))
+    logger.info('%d records, head:%d, dumped at %dus', count, head, now)
+
+    prev_seq = None
+    prev_time = None
+    for time, id, seq, a, b in events:
+        if prev_seq is not None and (prev_seq + 1) & 0xffff != seq:
+            print('%-12s --- %d record(s) overwritten' % ('', (seq - prev_seq - 1) & 0xffff))
+        name = names.get(id, '#%d' % id)
+        delta = (time - prev_time) & 0xffffffff if prev_time is not None else 0
+        age = (now - time) & 0xffffffff
+        print('%12.3f %+10.3f %5d %-12s %s' % (-age / 1000, delta / 1000, seq, name, describe(name, a, b, uris)))
+        prev_seq = seq
+        prev_time = time
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument('dump', nargs='?', default=None,
+                        help='Binary dump file, - reads the standard input')
+    parser.add_argument('--host', '-a', action='store', default=None,
+                        help='IP address of the ESP module to fetch the dump')
+    parser.add_argument('--header', action='store',
+                        default=os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'AutoConnectTrace.h'),
+                        help='AutoConnectTrace.h to read the event names')
+    parser.add_argument('--uri', '-u', action='append', default=[],
+                        help='Additional URI to resolve the REQUEST event')
+    parser.add_argument('--save', '-o', action='store', default=None,
+                        help='Save the fetched dump to the file')
+    parser.add_argument('--log', '-l', action='store', default='INFO',
+                        help='Logging level')
+    args = parser.parse_args()
+    loglevel = getattr(logging, args.log.upper(), None)
+    if not isinstance(loglevel, int):
+        raise ValueError('Invalid log level: %s' % args.log)
+    logging.basicConfig(level=loglevel)
+    logger = logging.getLogger(__name__)
+
+    if args.host:
+        with urllib.request.urlopen('http://%s/_ac/trace' % args.host, timeout=10) as res:
+            data = res.read()
+        if args.save:
+            with open(args.save, 'wb') as f:
+                f.write(data)
+    elif args.dump and args.dump != '-':
+        with open(args.dump, 'rb') as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    uris = {fnv1a(uri): uri for uri in URIS + args.uri}
+    decode(data, load_names(args.header), uris)
@@ -0,0 +1,273 @@
+#!python3.*
+
+"""portal load generator.
+
+Plays many concurrent clients against the captive portal of AutoConnect
+and reports the throughput, the latency percentiles, the error rates and
+the free heap low-water of the ESP module.
+"""
+
+import argparse
+import http.client
+import json
+import logging
+import random
+import re
+import socket
+import struct
+import sys
+import threading
+import time
+import urllib.parse
+
+# Connectivity probes fired by the client OSs, with their host names.
+PROBES = [
+    ('connectivitycheck.gstatic.com', '/generate_204'),
+    ('captive.apple.com', '/hotspot-detect.html'),
+    ('www.msftncsi.com', '/ncsi.txt'),
+    ('www.msftconnecttest.com', '/connecttest.txt'),
+    ('detectportal.firefox.com', '/success.txt'),
+    ('detectportal.firefox.com', '/canonical.html'),
+]
+
+# Default scenario, which a scenario file or the command line overrides.
+SCENARIO = {
+    'clients': 12,
+    'duration': 30,
+    'timeout': 5.0,
+    'think': 0.2,
+    'mix': {'dns': 4, 'probe': 4, 'page': 2, 'post': 0},
+    'pages': ['/_ac', '/_ac/config'],
+    'post': {'uri': '/_ac/connect', 'SSID': '', 'Passphrase': ''},
+    'heap_interval': 2.0,
+    'gates': {},
+}
+
+FREE_HEAP = re.compile(r'Free memory</td>\s*<td>(\d+)')
+
+
+class Recorder:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.latency = {}
+        self.errors = {}
+        self.heap = []
+
+    def record(self, action, elapsed, ok):
+        with self.lock:
+            self.latency.setdefault(action, [])
+            self.errors.setdefault(action, 0)
+            if ok:
+                self.latency[action].append(elapsed)
+            else:
+                self.errors[action] += 1
+
+    def record_heap(self, free):
+        with self.lock:
+            self.heap.append(free)
+
+
+class Client(threading.Thread):
+    def __init__(self, host, dns, scenario, recorder, stop):
+        threading.Thread.__init__(self, daemon=True)
+        self.host = host
+        self.dns = dns
+        self.scenario = scenario
+        self.recorder = recorder
+        self.stop = stop
+        self.actions = [a for a, w in scenario['mix'].items() for _ in range(w)]
+
+    def run(self):
+        if not self.actions:
+            return
+        while not self.stop.is_set():
+            action = random.choice(self.actions)
+            st = time.monotonic()
+            try:
+                ok = getattr(self, 'do_' + action)()
+            except (OSError, http.client.HTTPException) as e:
+                logger.debug('{0}: {1}'.format(action, e))
+                ok = False
+            self.recorder.record(action, time.monotonic() - st, ok)
+            if self.scenario['think']:
+                time.sleep(random.uniform(0, self.scenario['think']))
+
+    def request(self, method, uri, host=None, body=None, headers={}):
+        conn = http.client.HTTPConnection(self.host, 80, timeout=self.scenario['timeout'])
+        try:
+            h = {'Host': host or self.host, 'Connection': 'close'}
+            h.update(headers)
+            conn.request(method, uri, body=body, headers=h)
+            res = conn.getresponse()
+            payload = res.read()
+            return res.status, payload
+        finally:
+            conn.close()
+
+    def do_dns(self):
+        qid = random.getrandbits(16)
+        name = 'host{0}.example.com'.format(random.getrandbits(20))
+        query = struct.pack('>HHHHHH', qid, 0x0100, 1, 0, 0, 0)
+        query += b''.join(bytes([len(l)]) + l.encode() for l in name.split('.')) + b'\x00'
+        query += struct.pack('>HH', 1, 1)
+        with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as s:
+            s.settimeout(self.scenario['timeout'])
+            s.sendto(query, (self.dns, 53))
+            data = s.recv(512)
+        return len(data) >= 12 and struct.unpack('>H', data[:2])[0] == qid
+
+    def do_probe(self):
+        host, uri = random.choice(PROBES)
+        status, _ = self.request('GET', uri, host=host)
+        return status in (200, 204, 302)
+
+    def do_page(self):
+        status, _ = self.request('GET', random.choice(self.scenario['pages']))
+        return status == 200
+
+    def do_post(self):
+        post = self.scenario['post']
+        body = urllib.parse.urlencode({'SSID': post['SSID'], 'Passphrase': post['Passphrase']})
+        status, _ = self.request('POST', post['uri'], body=body, headers={'Content-Type': 'application/x-www-form-urlencoded'})
+        return status in (200, 302)
+
+
+class HeapMonitor(threading.Thread):
+    """Samples the free heap shown on the AutoConnect statistics page."""
+    def __init__(self, host, scenario, recorder, stop):
+        threading.Thread.__init__(self, daemon=True)
+        self.host = host
+        self.scenario = scenario
+        self.recorder = recorder
+        self.stop = stop
+
+    def run(self):
+        while not self.stop.wait(self.scenario['heap_interval']):
+            try:
+                conn = http.client.HTTPConnection(self.host, 80, timeout=self.scenario['timeout'])
+                conn.request('GET', '/_ac', headers={'Connection': 'close'})
+                m = FREE_HEAP.search(conn.getresponse().read().decode('utf-8', 'replace'))
+                conn.close()
+                if m:
+                    self.recorder.record_heap(int(m.group(1)))
+            except (OSError, http.client.HTTPException) as e:
+                logger.debug('heap: {0}'.format(e))
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(round(p / 100.0 * (len(values) - 1))))]
+
+
+def summarize(recorder, elapsed):
+    report = {'elapsed': elapsed, 'actions': {}}
+    total_ok = total_err = 0
+    all_latency = []
+    for action in sorted(recorder.latency):
+        lat = recorder.latency[action]
+        err = recorder.errors[action]
+        total_ok += len(lat)
+        total_err += err
+        all_latency += lat
+        report['actions'][action] = {
+            'requests': len(lat) + err,
+            'rps': len(lat) / elapsed,
+            'errors': 100.0 * err / max(1, len(lat) + err),
+            'p50': percentile(lat, 50) * 1000,
+            'p90': percentile(lat, 90) * 1000,
+            'p99': percentile(lat, 99) * 1000,
+        }
+    report['rps'] = total_ok / elapsed
+    report['errors'] = 100.0 * total_err / max(1, total_ok + total_err)
+    report['p50'] = percentile(all_latency, 50) * 1000
+    report['p90'] = percentile(all_latency, 90) * 1000
+    report['p99'] = percentile(all_latency, 99) * 1000
+    report['heap_low'] = min(recorder.heap) if recorder.heap else None
+    return report
+
+
+def print_report(report):
+    print('{0:<8}{1:>10}{2:>10}{3:>9}{4:>10}{5:>10}{6:>10}'.format('action', 'requests', 'req/s', 'err%', 'p50[ms]', 'p90[ms]', 'p99[ms]'))
+    for action, r in report['actions'].items():
+        print('{0:<8}{1:>10}{2:>10.1f}{3:>9.1f}{4:>10.1f}{5:>10.1f}{6:>10.1f}'.format(action, r['requests'], r['rps'], r['errors'], r['p50'], r['p90'], r['p99']))
+    print('{0:<8}{1:>10}{2:>10.1f}{3:>9.1f}{4:>10.1f}{5:>10.1f}{6:>10.1f}'.format('total', '', report['rps'], report['errors'], report['p50'], report['p90'], report['p99']))
+    print('free heap low-water: {0}'.format(report['heap_low'] if report['heap_low'] is not None else 'unknown'))
+
+
+def check_gates(report, gates):
+    """Returns the violated gates of the scenario."""
+    failed = []
+    if 'rps' in gates and report['rps'] < gates['rps']:
+        failed.append('rps {0:.1f} < {1}'.format(report['rps'], gates['rps']))
+    if 'errors' in gates and report['errors'] > gates['errors']:
+        failed.append('errors {0:.1f}% > {1}%'.format(report['errors'], gates['errors']))
+    if 'p99' in gates and report['p99'] > gates['p99']:
+        failed.append('p99 {0:.1f}ms > {1}ms'.format(report['p99'], gates['p99']))
+    if 'heap' in gates and report['heap_low'] is not None and report['heap_low'] < gates['heap']:
+        failed.append('heap {0} < {1}'.format(report['heap_low'], gates['heap']))
+    return failed
+
+
+def run(host, dns, scenario):
+    recorder = Recorder()
+    stop = threading.Event()
+    workers = [Client(host, dns, scenario, recorder, stop) for _ in range(scenario['clients'])]
+    if scenario['heap_interval']:
+        workers.append(HeapMonitor(host, scenario, recorder, stop))
+    logger.info('{0} clients against {1} for {2}s'.format(scenario['clients'], host, scenario['duration']))
+    st = time.monotonic()
+    for w in workers:
+        w.start()
+    try:
+        time.sleep(scenario['duration'])
+    except KeyboardInterrupt:
+        logger.info('Interrupted')
+    stop.set()
+    for w in workers:
+        w.join(scenario['timeout'] + 1)
+    return summarize(recorder, time.monotonic() - st)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--host', '-a', action='store', default='172.217.28.1',
+                        help='IP address of the portal [default:172.217.28.1]')
+    parser.add_argument('--dns', '-n', action='store', default=None,
+                        help='IP address of the DNS server [default:same as the host]')
+    parser.add_argument('--scenario', '-s', action='store', default=None,
+                        help='Scenario file in JSON')
+    parser.add_argument('--clients', '-c', action='store', type=int, default=None,
+                        help='Number of concurrent clients')
+    parser.add_argument('--duration', '-t', action='store', type=int, default=None,
+                        help='Duration of the run [s]')
+    parser.add_argument('--json', '-j', action='store', default=None,
+                        help='Output the report to the file in JSON')
+    parser.add_argument('--log', '-l', action='store', default='INFO',
+                        help='Logging level')
+    args = parser.parse_args()
+    loglevel = getattr(logging, args.log.upper(), None)
+    if not isinstance(loglevel, int):
+        raise ValueError('Invalid log level: %s' % args.log)
+    logging.basicConfig(level=loglevel)
+    logger = logging.getLogger(__name__)
+
+    scenario = dict(SCENARIO)
+    if args.scenario:
+        with open(args.scenario) as f:
+            scenario.update(json.load(f))
+    if args.clients is not None:
+        scenario['clients'] = args.clients
+    if args.duration is not None:
+        scenario['duration'] = args.duration
+
+    report = run(args.host, args.dns or args.host, scenario)
+    print_report(report)
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(report, f, indent=2)
+    failed = check_gates(report, scenario['gates'])
+    for f in failed:
+        logger.error('Gate failed: {0}'.format(f))
+    sys.exit(1 if failed else 0)